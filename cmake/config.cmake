@@ -65,6 +65,12 @@ set_property(CACHE QTE_QT_VERSION PROPERTY STRINGS 5)
 
 option(QTE_BUILD_DOCUMENTATION "Build API documentation" OFF)
 option(QTE_BUILD_DESIGNER_PLUGIN "Build plugin for Designer" ON)
+option(QTE_ENABLE_COROUTINES "Enable coroutine support (requires C++20)" OFF)
+
+# Coroutines require C++20
+if(QTE_ENABLE_COROUTINES AND CMAKE_CXX_STANDARD LESS 20)
+  set(CMAKE_CXX_STANDARD 20)
+endif()
 
 # Use RPATH on OS/X
 if(APPLE)
@@ -116,3 +122,7 @@ qte_test_cxx_feature(
   defaulted-ctor "compiler supports explicitly defaulted constructors")
 qte_test_cxx_feature(
   nested-template "compiler does not require space between template '>'s")
+if(QTE_ENABLE_COROUTINES)
+  qte_test_cxx_feature(
+    coroutines "compiler supports C++20 coroutines")
+endif()
@@ -0,0 +1,24 @@
+#include <coroutine>
+
+struct task
+{
+    struct promise_type
+    {
+        task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() {}
+    };
+};
+
+task run()
+{
+    co_await std::suspend_never{};
+}
+
+int main()
+{
+    run();
+    return 0;
+}
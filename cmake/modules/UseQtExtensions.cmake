@@ -1,23 +1,10 @@
 # - Use Module for QtExtensions
-# Provides CMake macros to use qte-amc.
-
-# qte_amc_wrap_ui(outfiles_var dialog_class_name input_ui_file ... )
-function(qte_amc_wrap_ui outvar name)
-  set(infiles)
-  set(outfiles)
-  foreach(it ${ARGN})
-    get_filename_component(outfile ${it} NAME_WE)
-    get_filename_component(infile ${it} ABSOLUTE)
-    list(APPEND infiles "${infile}")
-    list(APPEND outfiles "${CMAKE_CURRENT_BINARY_DIR}/am_${outfile}.h")
-  endforeach()
-  set(outfile "${CMAKE_CURRENT_BINARY_DIR}/${name}.h")
-  set_source_files_properties(${outfiles} ${outfile} PROPERTIES
-      GENERATED TRUE
-      SKIP_AUTOMOC TRUE
-      SKIP_AUTOUIC TRUE
-      SKIP_AUTORCC TRUE)
+# Provides CMake macros to use qte-amc and qte-sac.
 
+#------------------------------------------------------------------------------
+# Get command prefix to run a tool built against Qt with Qt on the path
+function(_qte_tool_environment outvar caller)
+  set(environment)
   if (NOT CMAKE_VERSION VERSION_LESS 3.1)
     if (WIN32)
       if(TARGET Qt5::qmake)
@@ -26,29 +13,52 @@ function(qte_amc_wrap_ui outvar name)
           PROPERTY IMPORTED_LOCATION
         )
       elseif(NOT DEFINED QT_QMAKE_EXECUTABLE)
-        message(FATAL_ERROR "Qt must be found before using qte_amc_wrap_ui")
+        message(FATAL_ERROR "Qt must be found before using ${caller}")
       endif()
       get_filename_component(QT_BIN_DIR "${QT_QMAKE_EXECUTABLE}" DIRECTORY)
 
-      set(QTE_AMC_ENVIRONMENT
+      set(environment
         ${CMAKE_COMMAND} -E env "\"PATH=${QT_BIN_DIR}\\;%PATH%\"")
     else()
       if(NOT TARGET Qt5::Core)
-        message(FATAL_ERROR "Qt must be found before using qte_amc_wrap_ui")
+        message(FATAL_ERROR "Qt must be found before using ${caller}")
       endif()
       get_property(QT_QTCORE_LIBRARY TARGET Qt5::Core PROPERTY LOCATION)
       get_filename_component(QT_LIB_DIR "${QT_QTCORE_LIBRARY}" DIRECTORY)
 
       if(APPLE)
-        set(QTE_AMC_ENVIRONMENT
+        set(environment
           ${CMAKE_COMMAND} -E env "\"DYLD_FALLBACK_LIBRARY_PATH=${QT_LIB_DIR}:\${DYLD_FALLBACK_LIBRARY_PATH}\"")
       else()
-        set(QTE_AMC_ENVIRONMENT
+        set(environment
           ${CMAKE_COMMAND} -E env "\"LD_LIBRARY_PATH=${QT_LIB_DIR}:\${LD_LIBRARY_PATH}\"")
       endif()
     endif()
   endif()
 
+  set(${outvar} ${environment} PARENT_SCOPE)
+endfunction()
+
+#------------------------------------------------------------------------------
+# qte_amc_wrap_ui(outfiles_var dialog_class_name input_ui_file ... )
+function(qte_amc_wrap_ui outvar name)
+  set(infiles)
+  set(outfiles)
+  foreach(it ${ARGN})
+    get_filename_component(outfile ${it} NAME_WE)
+    get_filename_component(infile ${it} ABSOLUTE)
+    list(APPEND infiles "${infile}")
+    list(APPEND outfiles "${CMAKE_CURRENT_BINARY_DIR}/am_${outfile}.h")
+  endforeach()
+  set(outfile "${CMAKE_CURRENT_BINARY_DIR}/${name}.h")
+  set_source_files_properties(${outfiles} ${outfile} PROPERTIES
+      GENERATED TRUE
+      SKIP_AUTOMOC TRUE
+      SKIP_AUTOUIC TRUE
+      SKIP_AUTORCC TRUE)
+
+  _qte_tool_environment(QTE_AMC_ENVIRONMENT qte_amc_wrap_ui)
+
   set(QTE_AMC_EXECUTABLE $<TARGET_FILE:qte-amc>)
 
   add_custom_command(OUTPUT ${outfiles} ${outfile}
@@ -57,3 +67,66 @@ function(qte_amc_wrap_ui outvar name)
     DEPENDS ${QTE_AMC_EXECUTABLE} ${infiles})
   set(${outvar} ${outfiles} ${outfile} PARENT_SCOPE)
 endfunction()
+
+#------------------------------------------------------------------------------
+# qte_add_svg_atlas(outfiles_var atlas_name
+#                   PREFIX resource_prefix
+#                   [SIZES size ...] [RATIOS ratio ...]
+#                   FILES svg_file ...)
+#
+# Pre-render SVG files at build time. Each SVG is rendered to fit square boxes
+# of the specified SIZES (and at its default size) at each device pixel ratio
+# in RATIOS. The images and an index are compiled into a Qt resource, which
+# qtSvgWidget uses in place of rendering at run time when it is showing one of
+# the SVGs at a pre-rendered size. The SVGs themselves are also compiled into
+# the resource, as ':<resource_prefix>/<file name>'. The generated source
+# files are returned in 'outfiles_var' and should be added to a target.
+function(qte_add_svg_atlas outvar name)
+  cmake_parse_arguments(_atlas "" "PREFIX" "SIZES;RATIOS;FILES" ${ARGN})
+
+  if(NOT _atlas_PREFIX)
+    message(FATAL_ERROR "qte_add_svg_atlas: no PREFIX specified")
+  endif()
+  if(NOT _atlas_FILES)
+    message(FATAL_ERROR "qte_add_svg_atlas: no FILES specified")
+  endif()
+  if(NOT _atlas_SIZES)
+    set(_atlas_SIZES 16 22 24 32 48 64)
+  endif()
+  if(NOT _atlas_RATIOS)
+    set(_atlas_RATIOS 1 1.5 2)
+  endif()
+  if(NOT TARGET Qt5::rcc)
+    message(FATAL_ERROR "Qt must be found before using qte_add_svg_atlas")
+  endif()
+
+  set(infiles)
+  foreach(it ${_atlas_FILES})
+    get_filename_component(infile ${it} ABSOLUTE)
+    list(APPEND infiles "${infile}")
+  endforeach()
+
+  string(REPLACE ";" "," sizes "${_atlas_SIZES}")
+  string(REPLACE ";" "," ratios "${_atlas_RATIOS}")
+
+  set(qrcfile "${CMAKE_CURRENT_BINARY_DIR}/${name}.qrc")
+  set(outfile "${CMAKE_CURRENT_BINARY_DIR}/qrc_${name}.cpp")
+  set_source_files_properties(${qrcfile} ${outfile} PROPERTIES
+      GENERATED TRUE
+      SKIP_AUTOMOC TRUE
+      SKIP_AUTOUIC TRUE
+      SKIP_AUTORCC TRUE)
+
+  _qte_tool_environment(QTE_SAC_ENVIRONMENT qte_add_svg_atlas)
+
+  set(QTE_SAC_EXECUTABLE $<TARGET_FILE:qte-sac>)
+  set(QTE_RCC_EXECUTABLE $<TARGET_FILE:Qt5::rcc>)
+
+  add_custom_command(OUTPUT ${qrcfile} ${outfile}
+    COMMAND ${QTE_SAC_ENVIRONMENT}
+            ${QTE_SAC_EXECUTABLE} ${qrcfile} ${_atlas_PREFIX}
+            ${sizes} ${ratios} ${infiles}
+    COMMAND ${QTE_RCC_EXECUTABLE} --name ${name} --output ${outfile} ${qrcfile}
+    DEPENDS ${QTE_SAC_EXECUTABLE} ${infiles})
+  set(${outvar} ${outfile} PARENT_SCOPE)
+endfunction()
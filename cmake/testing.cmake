@@ -26,7 +26,7 @@ function(qte_add_test)
 
   # Extract arguments
   set(_opts "SOURCES;MOC_HEADERS;LINK_LIBRARIES;ARGS")
-  cmake_parse_arguments("" "" "" "${_opts}" ${ARGN})
+  cmake_parse_arguments("" "BENCHMARK" "" "${_opts}" ${ARGN})
   list(APPEND _SOURCES ${_UNPARSED_ARGUMENTS}) # Use leftover args as sources
 
   if(NOT TARGET ${_EXECUTABLE})
@@ -43,6 +43,17 @@ function(qte_add_test)
   if(NOT _INTERACTIVE)
     add_test(NAME ${_NAME}
              COMMAND $<TARGET_FILE:${_EXECUTABLE}> ${_ARGS})
+
+    # Label benchmarks, so they can be run (or excluded) separately, and have
+    # them write their results where they can be collected
+    if(_BENCHMARK)
+      set_tests_properties(${_NAME} PROPERTIES
+        LABELS BENCHMARK
+        RUN_SERIAL TRUE
+        ENVIRONMENT
+          "QTE_BENCHMARK_OUTPUT=${CMAKE_CURRENT_BINARY_DIR}/${_NAME}.json"
+      )
+    endif()
   endif()
 endfunction()
 
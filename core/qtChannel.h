@@ -0,0 +1,448 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#ifndef __qtChannel_h
+#define __qtChannel_h
+
+/// \file
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+
+#include "qtGlobal.h"
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace qtChannelDetail
+{
+
+/// \cond internal
+
+enum { CacheLineSize = 64 };
+
+inline size_t roundCapacity(size_t capacity)
+{
+  size_t result = 2;
+  while (result < capacity)
+    result <<= 1;
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+struct Slot
+{
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+  T* value() { return reinterpret_cast<T*>(&this->storage); }
+};
+
+//-----------------------------------------------------------------------------
+// Bounded ring buffer for a single producer and single consumer
+template <typename T>
+class SpscRing
+{
+public:
+  explicit SpscRing(size_t capacity)
+    : mask(roundCapacity(capacity) - 1), slots(new Slot<T>[mask + 1]),
+      head(0), cachedTail(0), tail(0), cachedHead(0)
+  {}
+
+  ~SpscRing()
+  {
+    auto const t = this->tail.load(std::memory_order_acquire);
+    for (auto h = this->head.load(std::memory_order_relaxed); h != t; ++h)
+      this->slots[h & this->mask].value()->~T();
+    delete[] this->slots;
+  }
+
+  size_t capacity() const { return this->mask + 1; }
+
+  template <typename... Args>
+  bool tryPush(Args&&... args)
+  {
+    auto const t = this->tail.load(std::memory_order_relaxed);
+    if (t - this->cachedHead > this->mask)
+      {
+      this->cachedHead = this->head.load(std::memory_order_acquire);
+      if (t - this->cachedHead > this->mask)
+        return false;
+      }
+
+    new (this->slots[t & this->mask].value()) T(std::forward<Args>(args)...);
+    this->tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool tryPop(T& out)
+  {
+    auto const h = this->head.load(std::memory_order_relaxed);
+    if (h == this->cachedTail)
+      {
+      this->cachedTail = this->tail.load(std::memory_order_acquire);
+      if (h == this->cachedTail)
+        return false;
+      }
+
+    auto* const value = this->slots[h & this->mask].value();
+    out = std::move(*value);
+    value->~T();
+    this->head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+protected:
+  QTE_DISABLE_COPY(SpscRing)
+
+  size_t const mask;
+  Slot<T>* const slots;
+
+  // Consumer state; the cached tail avoids touching the producer's cache
+  // line until the consumer has drained what it already knows about
+  std::atomic<size_t> head;
+  size_t cachedTail;
+  char padding1[CacheLineSize];
+
+  // Producer state
+  std::atomic<size_t> tail;
+  size_t cachedHead;
+  char padding2[CacheLineSize];
+};
+
+//-----------------------------------------------------------------------------
+// Bounded ring buffer for multiple producers and a single consumer
+//
+// Each cell carries a sequence number which tells producers and the consumer
+// whether the cell is free, claimed or ready. Producers claim cells by
+// advancing the shared tail with a compare-and-swap.
+template <typename T>
+class MpscRing
+{
+public:
+  explicit MpscRing(size_t capacity)
+    : mask(roundCapacity(capacity) - 1), cells(new Cell[mask + 1]),
+      head(0), tail(0)
+  {
+    for (size_t i = 0; i <= this->mask; ++i)
+      this->cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  ~MpscRing()
+  {
+    for (auto h = this->head;; ++h)
+      {
+      auto& cell = this->cells[h & this->mask];
+      if (cell.sequence.load(std::memory_order_acquire) != h + 1)
+        break;
+      cell.slot.value()->~T();
+      }
+    delete[] this->cells;
+  }
+
+  size_t capacity() const { return this->mask + 1; }
+
+  template <typename... Args>
+  bool tryPush(Args&&... args)
+  {
+    auto t = this->tail.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;)
+      {
+      cell = this->cells + (t & this->mask);
+      auto const seq = cell->sequence.load(std::memory_order_acquire);
+      auto const diff =
+        static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(t);
+      if (diff == 0)
+        {
+        if (this->tail.compare_exchange_weak(t, t + 1,
+                                             std::memory_order_relaxed))
+          break;
+        }
+      else if (diff < 0)
+        {
+        return false; // Full
+        }
+      else
+        {
+        t = this->tail.load(std::memory_order_relaxed);
+        }
+      }
+
+    new (cell->slot.value()) T(std::forward<Args>(args)...);
+    cell->sequence.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool tryPop(T& out)
+  {
+    auto const h = this->head;
+    auto* const cell = this->cells + (h & this->mask);
+    if (cell->sequence.load(std::memory_order_acquire) != h + 1)
+      return false; // Empty, or producer has not finished writing
+
+    auto* const value = cell->slot.value();
+    out = std::move(*value);
+    value->~T();
+
+    this->head = h + 1;
+    cell->sequence.store(h + this->mask + 1, std::memory_order_release);
+    return true;
+  }
+
+protected:
+  QTE_DISABLE_COPY(MpscRing)
+
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    Slot<T> slot;
+  };
+
+  size_t const mask;
+  Cell* const cells;
+
+  size_t head; // Only accessed by the consumer
+  char padding1[CacheLineSize];
+
+  std::atomic<size_t> tail;
+  char padding2[CacheLineSize];
+};
+
+//-----------------------------------------------------------------------------
+// Parking spot for threads blocked on a channel
+//
+// Waiters register themselves before re-checking the channel, and notifiers
+// only take the lock if a waiter is registered, so that the uncontended path
+// never touches the mutex.
+class Waiter
+{
+public:
+  Waiter() : waiters(0) {}
+
+  template <typename Operation>
+  bool wait(Operation operation, unsigned long time)
+  {
+    // Spin briefly before sleeping; this avoids the cost of a context switch
+    // when the other side is keeping up
+    for (int i = 0; i < 64; ++i)
+      {
+      auto const result = operation();
+      if (result)
+        return result > 0;
+      }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QMutexLocker lock(&this->mutex);
+    for (;;)
+      {
+      this->waiters.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      auto const result = operation();
+      if (result)
+        {
+        this->waiters.fetch_sub(1, std::memory_order_relaxed);
+        return result > 0;
+        }
+
+      auto remaining = time;
+      if (time != ULONG_MAX)
+        {
+        auto const elapsed = static_cast<unsigned long>(timer.elapsed());
+        remaining = (elapsed < time ? time - elapsed : 0);
+        }
+
+      auto const woken =
+        remaining && this->condition.wait(&this->mutex, remaining);
+      this->waiters.fetch_sub(1, std::memory_order_relaxed);
+
+      if (!woken)
+        return operation() > 0;
+      }
+  }
+
+  void notify()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->waiters.load(std::memory_order_relaxed))
+      {
+      QMutexLocker lock(&this->mutex);
+      this->condition.wakeAll();
+      }
+  }
+
+protected:
+  QTE_DISABLE_COPY(Waiter)
+
+  QMutex mutex;
+  QWaitCondition condition;
+  std::atomic<int> waiters;
+};
+
+/// \endcond
+
+} // namespace qtChannelDetail
+
+//-----------------------------------------------------------------------------
+/// Bounded message channel between threads.
+///
+/// qtChannel is a fixed-capacity queue for passing messages between threads.
+/// Unlike a queued signal/slot connection, passing a message does not
+/// allocate memory or take a lock; the buffer is allocated once when the
+/// channel is created, and blocking operations only fall back to a mutex
+/// when the channel has been full or empty for some time.
+///
+/// Use qtSpscChannel when exactly one thread sends and one thread receives,
+/// and qtMpscChannel when several threads send to a single receiver.
+///
+/// Closing a channel causes receivers to return \c false once the remaining
+/// messages have been received, which makes it easy to write a consumer loop
+/// in the qtBareThread::run() of a qtThreadedObject.
+///
+/// \par Example:
+/// \code{.cpp}
+/// class Decoder : public qtThread
+/// {
+/// public:
+///     qtSpscChannel<Frame> frames{256};
+///
+/// protected:
+///     void run() override
+///     {
+///         Frame frame;
+///         while (this->frames.pop(frame))
+///             this->decode(frame);
+///     }
+/// };
+/// \endcode
+template <typename T, typename Ring>
+class qtChannel
+{
+public:
+  /// Construct a channel.
+  ///
+  /// The \p capacity is rounded up to the next power of two.
+  explicit qtChannel(size_t capacity) : ring(capacity), closed(false) {}
+
+  /// Get the number of messages the channel can hold.
+  size_t capacity() const { return this->ring.capacity(); }
+
+  /// Send a message, if the channel is not full.
+  ///
+  /// \return \c true if the message was sent, \c false if the channel was
+  ///         full or closed.
+  template <typename... Args>
+  bool tryPush(Args&&... args)
+  {
+    if (this->closed.load(std::memory_order_relaxed) ||
+        !this->ring.tryPush(std::forward<Args>(args)...))
+      return false;
+
+    this->notEmpty.notify();
+    return true;
+  }
+
+  /// Send a message, waiting for space if the channel is full.
+  ///
+  /// This sends \p value, blocking the caller until space is available in the
+  /// channel, the channel is closed, or the specified timeout (in
+  /// milliseconds) has elapsed. If \p time is \c ULONG_MAX (the default), the
+  /// call will never time out.
+  ///
+  /// \return \c true if the message was sent, \c false otherwise.
+  bool push(T value, unsigned long time = ULONG_MAX)
+  {
+    auto const pushed = this->notFull.wait(
+      [this, &value]() -> int {
+        if (this->closed.load(std::memory_order_acquire))
+          return -1;
+        return this->ring.tryPush(std::move(value)) ? 1 : 0;
+      }, time);
+
+    if (pushed)
+      this->notEmpty.notify();
+    return pushed;
+  }
+
+  /// Receive a message, if one is available.
+  ///
+  /// \return \c true if a message was received, \c false if the channel was
+  ///         empty.
+  bool tryPop(T& out)
+  {
+    if (!this->ring.tryPop(out))
+      return false;
+
+    this->notFull.notify();
+    return true;
+  }
+
+  /// Receive a message, waiting for one if the channel is empty.
+  ///
+  /// This receives a message into \p out, blocking the caller until a message
+  /// is available, the channel is closed and empty, or the specified timeout
+  /// (in milliseconds) has elapsed. If \p time is \c ULONG_MAX (the default),
+  /// the call will never time out.
+  ///
+  /// \return \c true if a message was received, \c false otherwise.
+  bool pop(T& out, unsigned long time = ULONG_MAX)
+  {
+    auto const popped = this->notEmpty.wait(
+      [this, &out]() -> int {
+        if (this->ring.tryPop(out))
+          return 1;
+        return this->closed.load(std::memory_order_acquire) ? -1 : 0;
+      }, time);
+
+    if (popped)
+      this->notFull.notify();
+    return popped;
+  }
+
+  /// Close the channel.
+  ///
+  /// After the channel is closed, no further messages may be sent. Messages
+  /// already in the channel may still be received. Blocked senders and
+  /// receivers are woken.
+  void close()
+  {
+    this->closed.store(true, std::memory_order_release);
+    this->notEmpty.notify();
+    this->notFull.notify();
+  }
+
+  /// Test if the channel has been closed.
+  bool isClosed() const
+  { return this->closed.load(std::memory_order_acquire); }
+
+protected:
+  QTE_DISABLE_COPY(qtChannel)
+
+  Ring ring;
+  std::atomic<bool> closed;
+
+  qtChannelDetail::Waiter notEmpty;
+  qtChannelDetail::Waiter notFull;
+};
+
+/// Bounded channel for a single sender thread and a single receiver thread.
+/// \sa qtChannel
+template <typename T>
+using qtSpscChannel = qtChannel<T, qtChannelDetail::SpscRing<T>>;
+
+/// Bounded channel for multiple sender threads and a single receiver thread.
+/// \sa qtChannel
+template <typename T>
+using qtMpscChannel = qtChannel<T, qtChannelDetail::MpscRing<T>>;
+
+#endif
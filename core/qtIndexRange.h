@@ -7,18 +7,33 @@
 #ifndef __qtIndexRange_h
 #define __qtIndexRange_h
 
+#include <cstddef>
+#include <iterator>
+
 //-----------------------------------------------------------------------------
 template <typename T> class qtIndexRangeType
 {
 public:
     class iterator;
+    using const_iterator = iterator;
+    using value_type = T;
+    using size_type = T;
 
-    qtIndexRangeType(T count) : End{count} {}
+    qtIndexRangeType(T count) : Begin{0}, End{count} {}
+    qtIndexRangeType(T first, T last) : Begin{first}, End{last} {}
 
-    iterator begin() const { return {T{0}}; }
+    iterator begin() const { return {Begin}; }
     iterator end() const { return {End}; }
 
+    T first() const { return Begin; }
+    T last() const { return End; }
+    T size() const { return (End > Begin ? End - Begin : T{0}); }
+    bool empty() const { return !(End > Begin); }
+
+    T operator[](T offset) const { return Begin + offset; }
+
 protected:
+    T Begin;
     T End;
 };
 
@@ -26,8 +41,44 @@ protected:
 template <typename T> class qtIndexRangeType<T>::iterator
 {
 public:
+    // Note: since the iterator yields values rather than references, this is
+    // strictly an input iterator; however, it provides all random access
+    // operations, and it is advertised as random access so that it may be
+    // used with algorithms that require such (e.g. parallel algorithms)
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T const*;
+    using reference = T;
+
+    iterator() : Value{0} {}
+
     T operator*() const { return Value; }
+    T operator[](difference_type n) const
+    { return static_cast<T>(Value + static_cast<T>(n)); }
+
     iterator& operator++() { ++Value; return *this; }
+    iterator& operator--() { --Value; return *this; }
+    iterator operator++(int) { auto const old = *this; ++Value; return old; }
+    iterator operator--(int) { auto const old = *this; --Value; return old; }
+
+    iterator& operator+=(difference_type n)
+    { Value = static_cast<T>(Value + static_cast<T>(n)); return *this; }
+    iterator& operator-=(difference_type n)
+    { Value = static_cast<T>(Value - static_cast<T>(n)); return *this; }
+
+    iterator operator+(difference_type n) const
+    { auto result = *this; return result += n; }
+    iterator operator-(difference_type n) const
+    { auto result = *this; return result -= n; }
+    friend iterator operator+(difference_type n, iterator const& i)
+    { return i + n; }
+
+    difference_type operator-(iterator const& other) const
+    {
+        return static_cast<difference_type>(Value) -
+               static_cast<difference_type>(other.Value);
+    }
 
     bool operator==(iterator const& other) const
     { return Value == other.Value; }
@@ -35,6 +86,15 @@ public:
     bool operator!=(iterator const& other) const
     { return Value != other.Value; }
 
+    bool operator<(iterator const& other) const
+    { return Value < other.Value; }
+    bool operator>(iterator const& other) const
+    { return Value > other.Value; }
+    bool operator<=(iterator const& other) const
+    { return Value <= other.Value; }
+    bool operator>=(iterator const& other) const
+    { return Value >= other.Value; }
+
 protected:
     friend class qtIndexRangeType<T>;
     iterator(T value) : Value{value} {}
@@ -48,4 +108,10 @@ template <typename T> auto qtIndexRange(T count) -> qtIndexRangeType<T>
     return {count};
 }
 
+//-----------------------------------------------------------------------------
+template <typename T> auto qtIndexRange(T first, T last) -> qtIndexRangeType<T>
+{
+    return {first, last};
+}
+
 #endif
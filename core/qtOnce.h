@@ -11,6 +11,10 @@
 
 #include "qtGlobal.h"
 
+#include <atomic>
+#include <mutex>
+#include <utility>
+
 #ifdef Q_OS_WIN
 
 #include <windows.h>
@@ -58,4 +62,154 @@ QTE_EXPORT void qtOnce(qtOnceGuard& guard, void(*func)(void));
 /// initializer for the guard.
 #define QTE_ONCE(name) qtOnceGuard name = QTE_ONCE_INIT
 
+//-----------------------------------------------------------------------------
+/// Flag for the callable form of qtOnce.
+///
+/// qtOnceFlag has a \c constexpr constructor, so a qtOnceFlag with static
+/// storage duration is initialized before any code runs, and does not need an
+/// initializer macro.
+class qtOnceFlag
+{
+public:
+  constexpr qtOnceFlag() : done(false) {}
+
+  /// Test if the function associated with the flag has completed.
+  bool isDone() const { return this->done.load(std::memory_order_acquire); }
+
+protected:
+  template <typename Function>
+  friend void qtOnce(qtOnceFlag&, Function&&);
+
+  QTE_DISABLE_COPY(qtOnceFlag)
+
+  std::atomic<bool> done;
+  std::mutex mutex;
+};
+
+//-----------------------------------------------------------------------------
+/// Call a callable object exactly once.
+///
+/// This overload of qtOnce accepts any callable object, including lambdas.
+/// Once \p function has completed, subsequent calls cost a single atomic
+/// load, which is performed inline.
+///
+/// Unlike the function pointer overload, \p function may throw. If it does,
+/// the exception propagates to the caller, and the flag is not set; the next
+/// call to qtOnce will try again.
+///
+/// \par Example:
+/// \code{.cpp}
+/// static qtOnceFlag flag;
+/// qtOnce(flag, [&]{ registerTypes(); });
+/// \endcode
+template <typename Function>
+inline void qtOnce(qtOnceFlag& flag, Function&& function)
+{
+  if (flag.done.load(std::memory_order_acquire))
+    {
+    return;
+    }
+
+  std::lock_guard<std::mutex> lock(flag.mutex);
+  if (!flag.done.load(std::memory_order_relaxed))
+    {
+    std::forward<Function>(function)();
+    flag.done.store(true, std::memory_order_release);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/// Lazily constructed, thread-safe singleton holder.
+///
+/// qtLazy holds a pointer to an object that is created on first access. Like
+/// qtOnceFlag, it has a \c constexpr constructor, and should be declared with
+/// static storage duration. Accessing the object after it has been created
+/// costs a single atomic load.
+///
+/// If the object is created by get() without a factory, it is owned by the
+/// holder, and is destroyed when the holder is destroyed. An object created
+/// by a factory is not owned by the holder; the factory is responsible for
+/// arranging its lifetime, e.g. by giving a QObject a parent.
+///
+/// \par Example:
+/// \code{.cpp}
+/// namespace { qtLazy<Registry> registry; }
+///
+/// Registry* Registry::instance()
+/// {
+///   return registry.get();
+/// }
+/// \endcode
+template <typename T>
+class qtLazy
+{
+public:
+  constexpr qtLazy() : instance(nullptr), owned(false) {}
+
+  ~qtLazy()
+    {
+    if (this->owned)
+      {
+      delete this->instance.load(std::memory_order_relaxed);
+      }
+    }
+
+  /// Get the object, creating it if necessary.
+  ///
+  /// This returns the object, default-constructing it on first access.
+  T* get()
+    {
+    if (auto const p = this->instance.load(std::memory_order_acquire))
+      {
+      return p;
+      }
+    return this->create([]{ return new T; }, true);
+    }
+
+  /// Get the object, creating it if necessary.
+  ///
+  /// This returns the object, calling \p factory to create it on first
+  /// access. The factory must return a pointer to the new object. If the
+  /// factory returns a null pointer (for example, because a prerequisite is
+  /// not yet available), this returns null, and the factory will be called
+  /// again on the next access.
+  template <typename Factory>
+  T* get(Factory&& factory)
+    {
+    if (auto const p = this->instance.load(std::memory_order_acquire))
+      {
+      return p;
+      }
+    return this->create(std::forward<Factory>(factory), false);
+    }
+
+  /// Test if the object has been created.
+  bool exists() const
+    { return !!this->instance.load(std::memory_order_acquire); }
+
+  T* operator->() { return this->get(); }
+  T& operator*() { return *this->get(); }
+
+protected:
+  QTE_DISABLE_COPY(qtLazy)
+
+  template <typename Factory>
+  T* create(Factory&& factory, bool takeOwnership)
+    {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto p = this->instance.load(std::memory_order_relaxed);
+    if (!p)
+      {
+      p = std::forward<Factory>(factory)();
+      this->owned = takeOwnership && p;
+      this->instance.store(p, std::memory_order_release);
+      }
+    return p;
+    }
+
+  std::atomic<T*> instance;
+  std::mutex mutex;
+  bool owned;
+};
+
 #endif
@@ -0,0 +1,269 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#ifndef __qtParallel_h
+#define __qtParallel_h
+
+/// \file
+
+#include "qtIndexRange.h"
+#include "qtThreadPool.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+
+#ifndef DOXYGEN
+
+//-----------------------------------------------------------------------------
+namespace qtParallelDetail
+{
+    // State shared between the calling thread and helper tasks
+    struct Loop
+    {
+        Loop(long long count, long long grain)
+            : ChunkCount{(count + grain - 1) / grain}, Next{0}, Completed{0}
+        {}
+
+        // Claim and execute chunks until none remain; returns after the last
+        // chunk claimed by this thread has completed
+        void run()
+        {
+            for (;;)
+            {
+                auto const chunk = Next.fetch_add(1);
+                if (chunk >= ChunkCount)
+                    return;
+
+                if (!Failed.load(std::memory_order_relaxed))
+                {
+                    try
+                    {
+                        Body(chunk);
+                    }
+                    catch (...)
+                    {
+                        QMutexLocker lock{&Mutex};
+                        if (!Failed.exchange(true))
+                            Exception = std::current_exception();
+                    }
+                }
+
+                if (Completed.fetch_add(1) + 1 == ChunkCount)
+                {
+                    QMutexLocker lock{&Mutex};
+                    Done.wakeAll();
+                }
+            }
+        }
+
+        void wait()
+        {
+            QMutexLocker lock{&Mutex};
+            while (Completed.load() < ChunkCount)
+                Done.wait(&Mutex);
+
+            if (Exception)
+                std::rethrow_exception(Exception);
+        }
+
+        std::function<void(long long)> Body;
+
+        long long const ChunkCount;
+        std::atomic<long long> Next;
+        std::atomic<long long> Completed;
+        std::atomic<bool> Failed{false};
+
+        QMutex Mutex;
+        QWaitCondition Done;
+        std::exception_ptr Exception;
+    };
+
+    //-------------------------------------------------------------------------
+    inline qtThreadPool* pool(qtThreadPool* pool)
+    {
+        return (pool ? pool : qtThreadPool::globalInstance());
+    }
+
+    //-------------------------------------------------------------------------
+    template <typename T>
+    long long grainSize(T count, T grain, qtThreadPool* pool)
+    {
+        if (grain > T{0})
+            return static_cast<long long>(grain);
+
+        // Aim for several chunks per thread, to even out load imbalance
+        auto const chunks = 4ll * pool->threadCount();
+        auto const n = static_cast<long long>(count);
+        return (n > chunks ? (n + chunks - 1) / chunks : 1ll);
+    }
+
+    //-------------------------------------------------------------------------
+    // Execute chunkBody(chunk, first, last) over chunks of a range
+    template <typename T, typename ChunkBody>
+    void forEachChunk(qtIndexRangeType<T> range, T grain, qtThreadPool* pool,
+                      ChunkBody&& chunkBody)
+    {
+        auto const count = static_cast<long long>(range.size());
+        if (count <= 0)
+            return;
+
+        auto const g = grainSize(range.size(), grain, pool);
+        auto const first = static_cast<long long>(range.first());
+        auto const loop = std::make_shared<Loop>(count, g);
+        loop->Body = [&chunkBody, first, count, g](long long chunk) {
+            auto const a = first + (chunk * g);
+            auto const b = first + std::min(count, (chunk + 1) * g);
+            chunkBody(chunk, static_cast<T>(a), static_cast<T>(b));
+        };
+
+        // Run small loops inline
+        if (loop->ChunkCount == 1)
+        {
+            loop->Body(0);
+            return;
+        }
+
+        // Start helpers; the calling thread also executes chunks, so the loop
+        // completes even if no pool workers are available (e.g. when called
+        // from a pool worker while all other workers are busy)
+        auto const helpers = static_cast<long long>(pool->threadCount());
+        auto const helperCount = std::min(helpers, loop->ChunkCount - 1);
+        for (long long n = 0; n < helperCount; ++n)
+        {
+            // Helpers hold a reference to the loop state, which outlives the
+            // call if a helper starts after all chunks have completed; such a
+            // helper finds no chunks to claim and does not touch the body
+            pool->post([loop]{ loop->run(); });
+        }
+
+        loop->run();
+        loop->wait();
+    }
+}
+
+#endif
+
+namespace qtParallel
+{
+    //-------------------------------------------------------------------------
+    /// Invoke a function for each index in a range, in parallel.
+    ///
+    /// This calls \p function for each index in \p range. The range is split
+    /// into chunks of \p grain indices, which are executed concurrently on
+    /// the workers of \p pool (or the global thread pool, if \p pool is null)
+    /// and on the calling thread. If \p grain is zero, a grain size is chosen
+    /// automatically based on the size of the range and the number of pool
+    /// workers.
+    ///
+    /// The call returns when all indices have been processed. If
+    /// \p function throws an exception, no further chunks are started, and
+    /// the first exception thrown is rethrown to the caller.
+    ///
+    /// \par Example:
+    /// \code{.cpp}
+    /// // Before
+    /// foreach (auto const i, qtIndexRange(list.count()))
+    ///     process(list[i]);
+    ///
+    /// // After
+    /// qtParallel::forEach(qtIndexRange(list.count()),
+    ///                     [&](int i){ process(list[i]); });
+    /// \endcode
+    template <typename T, typename Function>
+    void forEach(qtIndexRangeType<T> range, Function function,
+                 typename qtIndexRangeType<T>::size_type grain = 0,
+                 qtThreadPool* pool = nullptr)
+    {
+        pool = qtParallelDetail::pool(pool);
+        qtParallelDetail::forEachChunk(
+            range, grain, pool, [&function](long long, T first, T last) {
+                for (auto i = first; i < last; ++i)
+                    function(i);
+            });
+    }
+
+    //-------------------------------------------------------------------------
+    /// Compute a function for each index in a range, in parallel.
+    ///
+    /// This assigns <code>function(i)</code> to
+    /// <code>out[i - range.first()]</code> for each index \c i in \p range.
+    /// The output \p out must be a random access iterator (or a pointer) to
+    /// storage of sufficient size. See forEach() for the meaning of the other
+    /// parameters.
+    template <typename T, typename OutputIterator, typename Function>
+    void transform(qtIndexRangeType<T> range, OutputIterator out,
+                   Function function,
+                   typename qtIndexRangeType<T>::size_type grain = 0,
+                   qtThreadPool* pool = nullptr)
+    {
+        pool = qtParallelDetail::pool(pool);
+        auto const base = range.first();
+        qtParallelDetail::forEachChunk(
+            range, grain, pool,
+            [&function, &out, base](long long, T first, T last) {
+                for (auto i = first; i < last; ++i)
+                    out[i - base] = function(i);
+            });
+    }
+
+    //-------------------------------------------------------------------------
+    /// Combine values computed for each index in a range, in parallel.
+    ///
+    /// This computes <code>map(i)</code> for each index \c i in \p range, and
+    /// combines the results using \p combine, starting with \p init. Partial
+    /// results are combined in index order, so \p combine need not be
+    /// commutative; however, it must be associative, and \p init must be an
+    /// identity value for \p combine, as it is used as the initial value of
+    /// each chunk's partial result. See forEach() for the meaning of the other
+    /// parameters.
+    ///
+    /// \par Example:
+    /// \code{.cpp}
+    /// auto const sum = qtParallel::reduce(
+    ///   qtIndexRange(values.count()), 0.0,
+    ///   [&](int i){ return values[i]; }, std::plus<double>{});
+    /// \endcode
+    template <typename T, typename Value, typename MapFunction,
+              typename CombineFunction>
+    Value reduce(qtIndexRangeType<T> range, Value init, MapFunction map,
+                 CombineFunction combine,
+                 typename qtIndexRangeType<T>::size_type grain = 0,
+                 qtThreadPool* pool = nullptr)
+    {
+        pool = qtParallelDetail::pool(pool);
+
+        auto const count = static_cast<long long>(range.size());
+        if (count <= 0)
+            return init;
+
+        auto const g = qtParallelDetail::grainSize(range.size(), grain, pool);
+        auto const chunks = static_cast<size_t>((count + g - 1) / g);
+        // Note: not std::vector, which packs bool values into shared words,
+        // so that chunks writing neighbouring partial results do not race
+        std::deque<Value> partials(chunks, init);
+
+        qtParallelDetail::forEachChunk(
+            range, static_cast<T>(g), pool,
+            [&](long long chunk, T first, T last) {
+                auto& partial = partials[static_cast<size_t>(chunk)];
+                for (auto i = first; i < last; ++i)
+                    partial = combine(partial, map(i));
+            });
+
+        auto result = init;
+        for (auto const& partial : partials)
+            result = combine(result, partial);
+        return result;
+    }
+}
+
+#endif
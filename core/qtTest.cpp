@@ -7,13 +7,22 @@
 #include "qtStlUtil.h"
 #include "qtUtil.h"
 
+#include <QElapsedTimer>
+#include <QFile>
 #include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QRegExp>
 #include <QStack>
 #include <QThreadStorage>
+#include <QVector>
 
 #include <QMessageLogContext>
 
+#include <algorithm>
+#include <atomic>
+
 namespace // anonymous
 {
 
@@ -46,6 +55,31 @@ static void qtMessageHandler(
     qtMessageHandler(type, msg, qtTest::StreamPointer());
 }
 
+std::atomic<long long> allocationCount{0};
+std::atomic<bool> allocationCountingEnabled{false};
+
+//-----------------------------------------------------------------------------
+double percentile(QVector<double> const& sorted, double p)
+{
+    auto const pos = p * (sorted.count() - 1);
+    auto const lower = static_cast<int>(pos);
+    auto const upper = qMin(lower + 1, sorted.count() - 1);
+    auto const frac = pos - lower;
+    return sorted[lower] + ((sorted[upper] - sorted[lower]) * frac);
+}
+
+//-----------------------------------------------------------------------------
+QString formatTime(double ns)
+{
+    if (ns >= 1e9)
+        return QString::number(ns * 1e-9, 'f', 3) + " s";
+    if (ns >= 1e6)
+        return QString::number(ns * 1e-6, 'f', 3) + " ms";
+    if (ns >= 1e3)
+        return QString::number(ns * 1e-3, 'f', 3) + " us";
+    return QString::number(ns, 'f', 1) + " ns";
+}
+
 } // namespace <anonymous>
 
 //-----------------------------------------------------------------------------
@@ -61,6 +95,9 @@ public:
     QTextStream* out;
     QStack<qtTest::StreamPointer> streamStack;
     QStack<QString> traceStack;
+
+    QString currentSuite;
+    QJsonArray benchmarks;
 };
 
 QTE_IMPLEMENT_D_FUNC(qtTest)
@@ -86,6 +123,24 @@ qtTest::~qtTest()
     (*d->err) << '\n';
     d->err->flush();
 
+    // Write benchmark results, if requested
+    auto const& outputPath = qgetenv("QTE_BENCHMARK_OUTPUT");
+    if (!d->benchmarks.isEmpty() && !outputPath.isEmpty())
+    {
+        QFile file{QString::fromLocal8Bit(outputPath)};
+        if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            QJsonObject root;
+            root.insert("benchmarks", d->benchmarks);
+            file.write(QJsonDocument{root}.toJson());
+        }
+        else
+        {
+            (*d->err) << "failed to write benchmark results to "
+                      << file.fileName() << '\n';
+        }
+    }
+
     delete d;
 }
 
@@ -125,7 +180,9 @@ int qtTest::runSuite(QString const& name, qtTest::Suite suite)
 
     // Execute the test
     d->testResult = 0;
+    d->currentSuite = name;
     int result = (*suite)(*this) | d->testResult;
+    d->currentSuite.clear();
 
     // Restore stream for QDebug handler
     this->popMessageStream(token);
@@ -323,3 +380,228 @@ qtTestTrace::~qtTestTrace()
 
     delete d;
 }
+
+//-----------------------------------------------------------------------------
+class qtTestBenchmarkPrivate
+{
+public:
+    enum Phase
+    {
+        Start,
+        Calibrate,
+        Sample,
+        Finished
+    };
+
+    // Minimum duration of a sample; batches are sized so that timer
+    // resolution and loop overhead are negligible
+    static constexpr qint64 MinimumSampleTime = 2000000;
+    // Minimum duration of warm-up (which includes calibration)
+    static constexpr qint64 WarmUpTime = 50000000;
+    // Target duration of sampling, and bounds on the number of samples
+    static constexpr qint64 SamplingTime = 500000000;
+    static constexpr int MinimumSamples = 5;
+    static constexpr int MaximumSamples = 50;
+
+    void startBatch();
+    QJsonObject report();
+
+    qtTest* test;
+    QString suite;
+    QString name;
+    QString location;
+
+    Phase phase = Start;
+    long long batchSize = 1;
+    long long totalIterations = 0;
+
+    QElapsedTimer timer;
+    qint64 phaseStart = 0;
+    qint64 batchStart = 0;
+    long long batchAllocations = 0;
+
+    QVector<double> samples;
+    QVector<double> allocations;
+};
+
+QTE_IMPLEMENT_D_FUNC(qtTestBenchmark)
+
+//-----------------------------------------------------------------------------
+void qtTestBenchmarkPrivate::startBatch()
+{
+    this->batchAllocations = allocationCount.load(std::memory_order_relaxed);
+    this->batchStart = this->timer.nsecsElapsed();
+}
+
+//-----------------------------------------------------------------------------
+QJsonObject qtTestBenchmarkPrivate::report()
+{
+    auto sorted = this->samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    auto mean = 0.0;
+    foreach (auto const s, sorted)
+        mean += s;
+    mean /= sorted.count();
+
+    auto const median = percentile(sorted, 0.5);
+    auto const p10 = percentile(sorted, 0.1);
+    auto const p90 = percentile(sorted, 0.9);
+    auto const p99 = percentile(sorted, 0.99);
+
+    auto& out = this->test->out();
+    out << "  " << this->name << ": " << formatTime(median) << " median"
+        << " (p10 " << formatTime(p10) << ", p90 " << formatTime(p90)
+        << "), " << this->samples.count() << " x " << this->batchSize
+        << " iterations";
+
+    QJsonObject result;
+    result.insert("name", this->name);
+    result.insert("suite", this->suite);
+    if (!this->location.isEmpty())
+        result.insert("location", this->location);
+    result.insert("unit", QString{"ns"});
+    result.insert("samples", this->samples.count());
+    result.insert("iterationsPerSample", static_cast<double>(this->batchSize));
+    result.insert("min", sorted.first());
+    result.insert("max", sorted.last());
+    result.insert("mean", mean);
+    result.insert("median", median);
+    result.insert("p10", p10);
+    result.insert("p90", p90);
+    result.insert("p99", p99);
+
+    if (allocationCountingEnabled.load(std::memory_order_relaxed))
+    {
+        auto sortedAllocations = this->allocations;
+        std::sort(sortedAllocations.begin(), sortedAllocations.end());
+        auto const allocations = percentile(sortedAllocations, 0.5);
+        out << ", " << allocations << " allocations";
+        result.insert("allocations", allocations);
+    }
+
+    out << '\n';
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+qtTestBenchmark::qtTestBenchmark(
+    qtTest& test, QString const& name, int line, char const* file,
+    char const* func)
+    : d_ptr{new qtTestBenchmarkPrivate}, remaining{0}
+{
+    QTE_D();
+
+    Q_UNUSED(func);
+
+    d->test = &test;
+    d->suite = test.d_func()->currentSuite;
+    d->name = name;
+    if (file && line)
+    {
+        QFileInfo const fi{QString::fromLocal8Bit(file)};
+        d->location = QString{"%1:%2"}.arg(fi.fileName()).arg(line);
+    }
+}
+
+//-----------------------------------------------------------------------------
+qtTestBenchmark::~qtTestBenchmark()
+{
+    QTE_D();
+
+    // A benchmark that was exited early (e.g. by a failed test) does not
+    // have meaningful results
+    if (d->phase != qtTestBenchmarkPrivate::Finished)
+    {
+        d->test->out() << "  " << d->name
+                       << ": benchmark did not run to completion\n";
+    }
+
+    delete d;
+}
+
+//-----------------------------------------------------------------------------
+bool qtTestBenchmark::nextBatch()
+{
+    QTE_D();
+
+    auto const now = d->timer.isValid() ? d->timer.nsecsElapsed() : 0;
+    auto const elapsed = now - d->batchStart;
+
+    switch (d->phase)
+    {
+        case qtTestBenchmarkPrivate::Start:
+            d->timer.start();
+            d->phase = qtTestBenchmarkPrivate::Calibrate;
+            d->phaseStart = 0;
+            break;
+
+        case qtTestBenchmarkPrivate::Calibrate:
+            d->totalIterations += d->batchSize;
+            if (elapsed < qtTestBenchmarkPrivate::MinimumSampleTime)
+            {
+                // Grow the batch towards the minimum sample time, using the
+                // time taken so far as an estimate of the iteration time
+                auto const target = static_cast<double>(
+                    qtTestBenchmarkPrivate::MinimumSampleTime);
+                auto const scale =
+                    (elapsed > 0 ? target / static_cast<double>(elapsed)
+                                 : 10.0);
+                auto const growth = qBound(2.0, scale * 1.2, 10.0);
+                d->batchSize = static_cast<long long>(
+                    static_cast<double>(d->batchSize) * growth);
+            }
+            else if (now - d->phaseStart >= qtTestBenchmarkPrivate::WarmUpTime)
+            {
+                d->phase = qtTestBenchmarkPrivate::Sample;
+                d->phaseStart = now;
+            }
+            break;
+
+        case qtTestBenchmarkPrivate::Sample:
+        {
+            d->totalIterations += d->batchSize;
+
+            auto const batch = static_cast<double>(d->batchSize);
+            auto const allocations =
+                allocationCount.load(std::memory_order_relaxed) -
+                d->batchAllocations;
+            d->samples.append(static_cast<double>(elapsed) / batch);
+            d->allocations.append(static_cast<double>(allocations) / batch);
+
+            auto const count = d->samples.count();
+            auto const samplingTime = now - d->phaseStart;
+            if (count >= qtTestBenchmarkPrivate::MaximumSamples ||
+                (count >= qtTestBenchmarkPrivate::MinimumSamples &&
+                 samplingTime >= qtTestBenchmarkPrivate::SamplingTime))
+            {
+                d->phase = qtTestBenchmarkPrivate::Finished;
+                d->test->d_func()->benchmarks.append(d->report());
+                return false;
+            }
+            break;
+        }
+
+        case qtTestBenchmarkPrivate::Finished:
+            return false;
+    }
+
+    // Start the next batch; the current call accounts for its first iteration
+    this->remaining = d->batchSize - 1;
+    d->startBatch();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool qtTestBenchmark::enableAllocationCounting()
+{
+    allocationCountingEnabled.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void qtTestBenchmark::recordAllocation()
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+}
@@ -13,9 +13,12 @@
 #include <QTextStream>
 
 #include <cstdio>
+#include <cstdlib>
+#include <new>
 
 class qtTestPrivate;
 class qtTestTracePrivate;
+class qtTestBenchmarkPrivate;
 
 //-----------------------------------------------------------------------------
 class QTE_EXPORT qtTest
@@ -58,6 +61,7 @@ public:
 protected:
     QTE_DECLARE_PRIVATE_PTR(qtTest)
     friend class qtTestTrace;
+    friend class qtTestBenchmark;
 
     template <typename T>
     inline int failedEqualityTest(
@@ -87,6 +91,38 @@ private:
     QTE_DECLARE_PRIVATE(qtTestTrace)
 };
 
+//-----------------------------------------------------------------------------
+class QTE_EXPORT qtTestBenchmark
+{
+public:
+    qtTestBenchmark(qtTest& test, QString const& name, int line = 0,
+                    char const* file = 0, char const* func = 0);
+    ~qtTestBenchmark();
+
+    // Return true if the benchmark body should be executed (again); the body
+    // is run in batches, and only the end of a batch is out of line
+    inline bool next();
+
+    // Prevent the compiler from discarding a computed value
+    template <typename T>
+    static inline void keep(T const& value);
+
+    // Called by the allocation hook; see QTE_BENCHMARK_ALLOCATION_HOOK
+    static bool enableAllocationCounting();
+    static void recordAllocation();
+
+protected:
+    QTE_DECLARE_PRIVATE_PTR(qtTestBenchmark)
+
+    bool nextBatch();
+
+    long long remaining;
+
+private:
+    QTE_DECLARE_PRIVATE(qtTestBenchmark)
+    QTE_DISABLE_COPY(qtTestBenchmark)
+};
+
 //-----------------------------------------------------------------------------
 
 #ifndef _QT_TEST_FUNCTION_
@@ -125,6 +161,56 @@ private:
     TEST_OBJECT_NAME.popMessageStream(_token); \
     } while(0)
 
+// Run the following statement or block as a benchmark; the body is executed
+// repeatedly, after warming up and calibrating the number of iterations per
+// sample, and statistics are reported to the test output and (if the
+// QTE_BENCHMARK_OUTPUT environment variable names a file) as JSON
+#define TEST_BENCHMARK(_name) \
+    for (qtTestBenchmark _benchmark{TEST_OBJECT_NAME, _name, \
+                                    _QT_TEST_WHERE_}; \
+         _benchmark.next();)
+
+// Count allocations made by benchmarks; use once, at file scope, in the test
+// executable
+#if defined(__GLIBC__)
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+#define QTE_BENCHMARK_ALLOCATION_HOOK \
+    extern "C" void* malloc(size_t size) __THROW \
+    { \
+        qtTestBenchmark::recordAllocation(); \
+        return __libc_malloc(size); \
+    } \
+    extern "C" void* calloc(size_t count, size_t size) __THROW \
+    { \
+        qtTestBenchmark::recordAllocation(); \
+        return __libc_calloc(count, size); \
+    } \
+    extern "C" void* realloc(void* ptr, size_t size) __THROW \
+    { \
+        qtTestBenchmark::recordAllocation(); \
+        return __libc_realloc(ptr, size); \
+    } \
+    static bool const _qte_allocation_hook = \
+        qtTestBenchmark::enableAllocationCounting()
+#else
+#define QTE_BENCHMARK_ALLOCATION_HOOK \
+    void* operator new(std::size_t size) \
+    { \
+        qtTestBenchmark::recordAllocation(); \
+        if (auto* const p = std::malloc(size ? size : 1)) \
+            return p; \
+        throw std::bad_alloc{}; \
+    } \
+    void* operator new[](std::size_t size) \
+    { return operator new(size); } \
+    void operator delete(void* p) noexcept { std::free(p); } \
+    void operator delete[](void* p) noexcept { std::free(p); } \
+    static bool const _qte_allocation_hook = \
+        qtTestBenchmark::enableAllocationCounting()
+#endif
+
 //-----------------------------------------------------------------------------
 int qtTest::test(bool exprValue, QString const& exprText,
                  int line, char const* file, char const* func)
@@ -176,4 +262,27 @@ int qtTest::failedEqualityTest(
     return this->setTestResult(1);
 }
 
+//-----------------------------------------------------------------------------
+bool qtTestBenchmark::next()
+{
+    if (this->remaining > 0)
+    {
+        --this->remaining;
+        return true;
+    }
+    return this->nextBatch();
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void qtTestBenchmark::keep(T const& value)
+{
+#if defined Q_CC_GNU
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    auto const* volatile sink = &value;
+    Q_UNUSED(sink);
+#endif
+}
+
 #endif
@@ -4,22 +4,205 @@
 
 #include "qtThread.h"
 
+#include <QMutex>
+#include <QMutexLocker>
+
+#if defined(Q_OS_WIN)
+#  include <windows.h>
+#elif defined(Q_OS_UNIX)
+#  include <pthread.h>
+#  include <time.h>
+#  include <unistd.h>
+#  ifdef Q_OS_LINUX
+#    include <sched.h>
+#  endif
+#endif
+
 QTE_IMPLEMENT_D_FUNC(qtBareThread)
 
+namespace // anonymous
+{
+
+#if defined(Q_OS_WIN)
+using NativeThread = DWORD;
+NativeThread currentNativeThread() { return GetCurrentThreadId(); }
+#elif defined(Q_OS_UNIX)
+using NativeThread = pthread_t;
+NativeThread currentNativeThread() { return pthread_self(); }
+#else
+using NativeThread = int;
+NativeThread currentNativeThread() { return 0; }
+#endif
+
+//-----------------------------------------------------------------------------
+void applyName(NativeThread thread, QString const& name)
+{
+  if (name.isEmpty())
+    {
+    return;
+    }
+
+#if defined(Q_OS_LINUX)
+  // Linux limits names to 16 bytes, including the terminator; truncate at a
+  // character boundary, i.e. not before a UTF-8 continuation byte
+  auto bytes = name.toUtf8();
+  if (bytes.size() > 15)
+    {
+    auto size = 15;
+    while (size > 0 && (static_cast<uchar>(bytes[size]) & 0xc0) == 0x80)
+      --size;
+    bytes.truncate(size);
+    }
+  pthread_setname_np(thread, bytes.constData());
+#elif defined(Q_OS_MAC)
+  // macOS can only set the name of the calling thread
+  if (pthread_equal(thread, pthread_self()))
+    {
+    pthread_setname_np(name.toUtf8().constData());
+    }
+#else
+  Q_UNUSED(thread)
+#endif
+}
+
+//-----------------------------------------------------------------------------
+void applyAffinity(NativeThread thread, QVector<int> const& cpus)
+{
+#if defined(Q_OS_LINUX)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (cpus.isEmpty())
+    {
+    for (int i = 0; i < CPU_SETSIZE; ++i)
+      CPU_SET(i, &set);
+    }
+  else
+    {
+    foreach (auto const cpu, cpus)
+      {
+      if (cpu >= 0 && cpu < CPU_SETSIZE)
+        CPU_SET(cpu, &set);
+      }
+    }
+  pthread_setaffinity_np(thread, sizeof(set), &set);
+#elif defined(Q_OS_WIN)
+  auto mask = DWORD_PTR{0};
+  if (cpus.isEmpty())
+    {
+    DWORD_PTR systemMask;
+    GetProcessAffinityMask(GetCurrentProcess(), &mask, &systemMask);
+    }
+  else
+    {
+    foreach (auto const cpu, cpus)
+      {
+      if (cpu >= 0 && cpu < static_cast<int>(sizeof(DWORD_PTR) * 8))
+        mask |= (DWORD_PTR{1} << cpu);
+      }
+    }
+
+  if (auto const handle =
+        OpenThread(THREAD_SET_INFORMATION | THREAD_QUERY_INFORMATION,
+                   FALSE, thread))
+    {
+    SetThreadAffinityMask(handle, mask);
+    CloseHandle(handle);
+    }
+#else
+  Q_UNUSED(thread)
+  Q_UNUSED(cpus)
+#endif
+}
+
+//-----------------------------------------------------------------------------
+qint64 cpuTime(NativeThread thread)
+{
+#if defined(Q_OS_WIN)
+  auto const handle =
+    OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, thread);
+  if (!handle)
+    {
+    return -1;
+    }
+
+  FILETIME creationTime, exitTime, kernelTime, userTime;
+  auto const result =
+    GetThreadTimes(handle, &creationTime, &exitTime, &kernelTime, &userTime);
+  CloseHandle(handle);
+  if (!result)
+    {
+    return -1;
+    }
+
+  // FILETIME is in units of 100 ns
+  auto const toInt = [](FILETIME const& ft){
+    return (static_cast<qint64>(ft.dwHighDateTime) << 32) |
+           static_cast<qint64>(ft.dwLowDateTime);
+  };
+  return (toInt(kernelTime) + toInt(userTime)) / 10;
+#elif defined(Q_OS_UNIX) && defined(_POSIX_THREAD_CPUTIME)
+  clockid_t clock;
+  timespec ts;
+  if (pthread_getcpuclockid(thread, &clock) || clock_gettime(clock, &ts))
+    {
+    return -1;
+    }
+  return (static_cast<qint64>(ts.tv_sec) * 1000000) + (ts.tv_nsec / 1000);
+#else
+  Q_UNUSED(thread)
+  return -1;
+#endif
+}
+
+} // namespace <anonymous>
+
 //-----------------------------------------------------------------------------
 class qtBareThreadPrivate : public QThread
 {
 public:
-  qtBareThreadPrivate(qtBareThread* parent) : q_ptr(parent) {}
+  qtBareThreadPrivate(qtBareThread* parent)
+    : q_ptr(parent), threadPriority(QThread::InheritPriority),
+      nativeThread(), nativeThreadValid(false) {}
   virtual ~qtBareThreadPrivate() {}
 
-  virtual void run() { QTE_Q(qtBareThread); q->run(); }
+  virtual void run();
+
+  mutable QMutex mutex;
+
+  QString threadName;
+  QVector<int> threadAffinity;
+  QThread::Priority threadPriority;
+
+  NativeThread nativeThread;
+  bool nativeThreadValid;
 
 private:
   QTE_DECLARE_PUBLIC(qtBareThread)
   QTE_DECLARE_PUBLIC_PTR(qtBareThread)
 };
 
+//-----------------------------------------------------------------------------
+void qtBareThreadPrivate::run()
+{
+  QTE_Q(qtBareThread);
+
+  // Apply thread settings in the context of the new thread
+  QMutexLocker lock(&this->mutex);
+  this->nativeThread = currentNativeThread();
+  this->nativeThreadValid = true;
+  applyName(this->nativeThread, this->threadName);
+  if (!this->threadAffinity.isEmpty())
+    {
+    applyAffinity(this->nativeThread, this->threadAffinity);
+    }
+  lock.unlock();
+
+  q->run();
+
+  lock.relock();
+  this->nativeThreadValid = false;
+}
+
 //-----------------------------------------------------------------------------
 qtBareThread::qtBareThread(QObject* self)
   : d_ptr(new qtBareThreadPrivate(this))
@@ -39,7 +222,12 @@ qtBareThread::~qtBareThread()
 void qtBareThread::start()
 {
   QTE_D(qtBareThread);
-  d->start();
+
+  QMutexLocker lock(&d->mutex);
+  auto const priority = d->threadPriority;
+  lock.unlock();
+
+  d->start(priority);
 }
 
 //-----------------------------------------------------------------------------
@@ -70,6 +258,90 @@ bool qtBareThread::isRunning() const
   return d->isRunning();
 }
 
+//-----------------------------------------------------------------------------
+void qtBareThread::setThreadName(QString const& name)
+{
+  QTE_D(qtBareThread);
+
+  QMutexLocker lock(&d->mutex);
+  d->threadName = name;
+  d->setObjectName(name);
+  if (d->nativeThreadValid)
+    {
+    applyName(d->nativeThread, name);
+    }
+}
+
+//-----------------------------------------------------------------------------
+QString qtBareThread::threadName() const
+{
+  QTE_D_CONST(qtBareThread);
+
+  QMutexLocker lock(&d->mutex);
+  return d->threadName;
+}
+
+//-----------------------------------------------------------------------------
+void qtBareThread::setThreadAffinity(QVector<int> const& cpus)
+{
+  QTE_D(qtBareThread);
+
+  QMutexLocker lock(&d->mutex);
+  d->threadAffinity = cpus;
+  if (d->nativeThreadValid)
+    {
+    applyAffinity(d->nativeThread, cpus);
+    }
+}
+
+//-----------------------------------------------------------------------------
+QVector<int> qtBareThread::threadAffinity() const
+{
+  QTE_D_CONST(qtBareThread);
+
+  QMutexLocker lock(&d->mutex);
+  return d->threadAffinity;
+}
+
+//-----------------------------------------------------------------------------
+void qtBareThread::setThreadPriority(QThread::Priority priority)
+{
+  QTE_D(qtBareThread);
+
+  QMutexLocker lock(&d->mutex);
+  d->threadPriority = priority;
+  lock.unlock();
+
+  if (d->isRunning() && priority != QThread::InheritPriority)
+    {
+    d->setPriority(priority);
+    }
+}
+
+//-----------------------------------------------------------------------------
+QThread::Priority qtBareThread::threadPriority() const
+{
+  QTE_D_CONST(qtBareThread);
+
+  QMutexLocker lock(&d->mutex);
+  return d->threadPriority;
+}
+
+//-----------------------------------------------------------------------------
+qint64 qtBareThread::threadCpuTime() const
+{
+  QTE_D_CONST(qtBareThread);
+
+  QMutexLocker lock(&d->mutex);
+  return (d->nativeThreadValid ? cpuTime(d->nativeThread) : -1);
+}
+
+//-----------------------------------------------------------------------------
+qint64 qtBareThread::currentThreadCpuTime()
+{
+  return cpuTime(currentNativeThread());
+}
+
 //-----------------------------------------------------------------------------
 void qtBareThread::sleep(unsigned long seconds)
 {
@@ -7,7 +7,9 @@
 
 /// \file
 
+#include <QString>
 #include <QThread>
+#include <QVector>
 
 #include "qtGlobal.h"
 
@@ -57,6 +59,59 @@ public:
   /// Test if the thread is running.
   virtual bool isRunning() const;
 
+  /// Set the name of the thread.
+  ///
+  /// This sets the name by which the thread is known to the operating system,
+  /// which is shown by debuggers and profilers. The name is applied when the
+  /// thread starts, or immediately if the thread is already running. Some
+  /// platforms limit the length of thread names (on Linux, to 15 bytes of
+  /// UTF-8), in which case the name is truncated to the longest sequence of
+  /// whole characters that fits.
+  void setThreadName(QString const& name);
+
+  /// Get the name of the thread.
+  QString threadName() const;
+
+  /// Set the processors on which the thread may execute.
+  ///
+  /// This restricts the thread to execute only on the logical processors
+  /// whose (zero-based) indices are given in \p cpus. An empty list removes
+  /// any restriction. The affinity is applied when the thread starts, or
+  /// immediately if the thread is already running.
+  ///
+  /// \note Processor affinity is supported on Linux and Windows. On other
+  ///       platforms, this setting is ignored.
+  void setThreadAffinity(QVector<int> const& cpus);
+
+  /// Get the processors on which the thread may execute.
+  ///
+  /// \return The list of processors set by setThreadAffinity.
+  QVector<int> threadAffinity() const;
+
+  /// Set the scheduling priority of the thread.
+  ///
+  /// The priority is applied when the thread starts, or immediately if the
+  /// thread is already running.
+  ///
+  /// \sa QThread::setPriority
+  void setThreadPriority(QThread::Priority priority);
+
+  /// Get the scheduling priority of the thread.
+  QThread::Priority threadPriority() const;
+
+  /// Get the processor time consumed by the thread.
+  ///
+  /// This returns the amount of processor time, in microseconds, that the
+  /// thread has consumed (in both user and kernel mode). If the thread is not
+  /// running, or if the platform does not support per-thread processor time
+  /// accounting, returns -1.
+  qint64 threadCpuTime() const;
+
+  /// Get the processor time consumed by the calling thread.
+  ///
+  /// \sa threadCpuTime
+  static qint64 currentThreadCpuTime();
+
   /// Block execution for specified number of seconds.
   static void sleep(unsigned long seconds);
   /// Block execution for specified number of milliseconds.
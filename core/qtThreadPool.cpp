@@ -0,0 +1,396 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#include "qtThreadPool.h"
+
+#include "qtThread.h"
+
+#include <QAtomicInt>
+#include <QEnableSharedFromThis>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+
+#include <deque>
+#include <vector>
+
+QTE_IMPLEMENT_D_FUNC(qtThreadPool)
+QTE_IMPLEMENT_D_FUNC(qtThreadPoolQueue)
+
+namespace // anonymous
+{
+
+using Task = std::function<void()>;
+
+constexpr int PriorityCount = qtThreadPool::HighPriority + 1;
+
+//-----------------------------------------------------------------------------
+class Worker : public qtThread
+{
+public:
+  Worker(qtThreadPoolPrivate* pool, int index) : pool(pool), index(index) {}
+
+  bool pop(Task& task);
+  bool steal(Task& task);
+
+  void push(Task&& task, qtThreadPool::Priority priority);
+
+protected:
+  void run() override;
+
+  qtThreadPoolPrivate* const pool;
+  int const index;
+
+  QMutex mutex;
+  std::deque<Task> queues[PriorityCount];
+};
+
+// Identifies the pool and worker (if any) of the calling thread
+struct WorkerContext
+{
+  qtThreadPoolPrivate* pool;
+  int index;
+};
+
+thread_local WorkerContext currentWorker = { 0, -1 };
+
+} // namespace <anonymous>
+
+//-----------------------------------------------------------------------------
+class qtThreadPoolPrivate
+{
+public:
+  qtThreadPoolPrivate() : nextWorker(0), pending(0), outstanding(0),
+                          stopping(false) {}
+
+  void push(Task&& task, qtThreadPool::Priority priority);
+  bool take(int index, Task& task);
+  void finish();
+
+  std::vector<Worker*> workers;
+  QAtomicInt nextWorker;
+
+  QMutex mutex;
+  QWaitCondition workAvailable;
+  QWaitCondition done;
+
+  QAtomicInt pending;
+  QAtomicInt outstanding;
+  bool stopping;
+};
+
+//-----------------------------------------------------------------------------
+class qtThreadPoolQueuePrivate
+  : public QEnableSharedFromThis<qtThreadPoolQueuePrivate>
+{
+public:
+  qtThreadPoolQueuePrivate(qtThreadPool* pool,
+                           qtThreadPool::Priority priority)
+    : pool(pool), priority(priority), scheduled(false), executing(0) {}
+
+  void schedule();
+  void drain();
+
+  qtThreadPool* const pool;
+  qtThreadPool::Priority const priority;
+
+  mutable QMutex mutex;
+  QWaitCondition done;
+  std::deque<Task> tasks;
+  bool scheduled;
+  Qt::HANDLE executing;
+};
+
+//-----------------------------------------------------------------------------
+bool Worker::pop(Task& task)
+{
+  QMutexLocker lock(&this->mutex);
+
+  // Take most recently queued task, from highest priority non-empty queue
+  for (int p = PriorityCount; p--;)
+    {
+    auto& queue = this->queues[p];
+    if (!queue.empty())
+      {
+      task = std::move(queue.back());
+      queue.pop_back();
+      return true;
+      }
+    }
+
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+bool Worker::steal(Task& task)
+{
+  QMutexLocker lock(&this->mutex);
+
+  // Take least recently queued task, from highest priority non-empty queue
+  for (int p = PriorityCount; p--;)
+    {
+    auto& queue = this->queues[p];
+    if (!queue.empty())
+      {
+      task = std::move(queue.front());
+      queue.pop_front();
+      return true;
+      }
+    }
+
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+void Worker::push(Task&& task, qtThreadPool::Priority priority)
+{
+  QMutexLocker lock(&this->mutex);
+  this->queues[priority].push_back(std::move(task));
+}
+
+//-----------------------------------------------------------------------------
+void Worker::run()
+{
+  currentWorker.pool = this->pool;
+  currentWorker.index = this->index;
+
+  auto* const pool = this->pool;
+  Task task;
+
+  while (true)
+    {
+    if (pool->take(this->index, task))
+      {
+      task();
+      task = nullptr;
+      pool->finish();
+      continue;
+      }
+
+    QMutexLocker lock(&pool->mutex);
+    if (pool->stopping && pool->pending.load() == 0)
+      {
+      break;
+      }
+    if (pool->pending.load() == 0)
+      {
+      pool->workAvailable.wait(&pool->mutex);
+      }
+    }
+
+  currentWorker.pool = 0;
+  currentWorker.index = -1;
+}
+
+//-----------------------------------------------------------------------------
+void qtThreadPoolPrivate::push(Task&& task, qtThreadPool::Priority priority)
+{
+  this->outstanding.ref();
+  this->pending.ref();
+
+  // Queue task on the calling worker if it belongs to this pool, otherwise
+  // distribute tasks among workers
+  auto const count = static_cast<int>(this->workers.size());
+  auto const index =
+    (currentWorker.pool == this
+     ? currentWorker.index
+     : static_cast<int>(
+         static_cast<unsigned>(this->nextWorker.fetchAndAddRelaxed(1)) %
+         static_cast<unsigned>(count)));
+  this->workers[index]->push(std::move(task), priority);
+
+  // Wake an idle worker; the pending count was incremented before taking the
+  // lock so that a worker about to go idle does not miss the task
+  QMutexLocker lock(&this->mutex);
+  this->workAvailable.wakeOne();
+}
+
+//-----------------------------------------------------------------------------
+bool qtThreadPoolPrivate::take(int index, Task& task)
+{
+  auto const count = static_cast<int>(this->workers.size());
+
+  // Try own queue first, then try to steal from other workers
+  auto found = this->workers[index]->pop(task);
+  for (int n = 1; !found && n < count; ++n)
+    {
+    found = this->workers[(index + n) % count]->steal(task);
+    }
+
+  if (found)
+    {
+    this->pending.deref();
+    }
+  return found;
+}
+
+//-----------------------------------------------------------------------------
+void qtThreadPoolPrivate::finish()
+{
+  if (!this->outstanding.deref())
+    {
+    QMutexLocker lock(&this->mutex);
+    this->done.wakeAll();
+    }
+}
+
+//-----------------------------------------------------------------------------
+qtThreadPool::qtThreadPool(int threadCount)
+  : d_ptr(new qtThreadPoolPrivate)
+{
+  QTE_D(qtThreadPool);
+
+  if (threadCount < 1)
+    {
+    threadCount = qMax(1, QThread::idealThreadCount());
+    }
+
+  d->workers.reserve(static_cast<size_t>(threadCount));
+  for (int i = 0; i < threadCount; ++i)
+    {
+    d->workers.push_back(new Worker(d, i));
+    }
+  for (auto* const worker : d->workers)
+    {
+    worker->start();
+    }
+}
+
+//-----------------------------------------------------------------------------
+qtThreadPool::~qtThreadPool()
+{
+  QTE_D(qtThreadPool);
+
+  this->waitForDone();
+
+  QMutexLocker lock(&d->mutex);
+  d->stopping = true;
+  d->workAvailable.wakeAll();
+  lock.unlock();
+
+  for (auto* const worker : d->workers)
+    {
+    worker->wait();
+    delete worker;
+    }
+}
+
+//-----------------------------------------------------------------------------
+qtThreadPool* qtThreadPool::globalInstance()
+{
+  static qtThreadPool instance;
+  return &instance;
+}
+
+//-----------------------------------------------------------------------------
+int qtThreadPool::threadCount() const
+{
+  QTE_D_CONST(qtThreadPool);
+  return static_cast<int>(d->workers.size());
+}
+
+//-----------------------------------------------------------------------------
+void qtThreadPool::post(std::function<void()> task, Priority priority)
+{
+  QTE_D(qtThreadPool);
+  d->push(std::move(task), priority);
+}
+
+//-----------------------------------------------------------------------------
+void qtThreadPool::waitForDone()
+{
+  QTE_D(qtThreadPool);
+
+  QMutexLocker lock(&d->mutex);
+  while (d->outstanding.load())
+    {
+    d->done.wait(&d->mutex);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qtThreadPoolQueuePrivate::schedule()
+{
+  auto self = this->sharedFromThis();
+  this->pool->post([self]{ self->drain(); }, this->priority);
+}
+
+//-----------------------------------------------------------------------------
+void qtThreadPoolQueuePrivate::drain()
+{
+  // Execute a limited number of tasks before yielding the worker, so that a
+  // busy queue does not starve other work
+  for (int n = 0; n < 32; ++n)
+    {
+    QMutexLocker lock(&this->mutex);
+    if (this->tasks.empty())
+      {
+      this->scheduled = false;
+      this->done.wakeAll();
+      return;
+      }
+
+    auto task = std::move(this->tasks.front());
+    this->tasks.pop_front();
+    this->executing = QThread::currentThreadId();
+    lock.unlock();
+
+    task();
+
+    lock.relock();
+    this->executing = 0;
+    }
+
+  this->schedule();
+}
+
+//-----------------------------------------------------------------------------
+qtThreadPoolQueue::qtThreadPoolQueue(
+  qtThreadPool* pool, qtThreadPool::Priority priority)
+  : d_ptr(new qtThreadPoolQueuePrivate(
+            pool ? pool : qtThreadPool::globalInstance(), priority))
+{
+}
+
+//-----------------------------------------------------------------------------
+qtThreadPoolQueue::~qtThreadPoolQueue()
+{
+  this->waitForDone();
+}
+
+//-----------------------------------------------------------------------------
+void qtThreadPoolQueue::post(std::function<void()> task)
+{
+  QTE_D(qtThreadPoolQueue);
+
+  QMutexLocker lock(&d->mutex);
+  d->tasks.push_back(std::move(task));
+  if (!d->scheduled)
+    {
+    d->scheduled = true;
+    lock.unlock();
+    d->schedule();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qtThreadPoolQueue::waitForDone()
+{
+  QTE_D(qtThreadPoolQueue);
+
+  QMutexLocker lock(&d->mutex);
+  while (d->scheduled)
+    {
+    d->done.wait(&d->mutex);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool qtThreadPoolQueue::isCurrent() const
+{
+  QTE_D_CONST(qtThreadPoolQueue);
+
+  QMutexLocker lock(&d->mutex);
+  return d->executing == QThread::currentThreadId();
+}
@@ -0,0 +1,202 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#ifndef __qtThreadPool_h
+#define __qtThreadPool_h
+
+/// \file
+
+#include <QScopedPointer>
+
+#include "qtGlobal.h"
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <utility>
+
+class qtThreadPoolPrivate;
+class qtThreadPoolQueuePrivate;
+
+//-----------------------------------------------------------------------------
+/// Pool of worker threads executing short-lived tasks.
+///
+/// qtThreadPool maintains a fixed set of worker threads (by default, one per
+/// logical processor) which execute submitted tasks. Each worker owns its own
+/// task queue; tasks submitted from a worker thread are queued on that
+/// worker, and workers whose queues are empty steal work from other workers.
+/// This keeps the number of threads near the number of processors, while
+/// still keeping all processors busy when work is available.
+///
+/// Tasks may be given a priority. A worker always runs the highest priority
+/// task available in its own queue, or (when stealing) in the queue of the
+/// worker it is stealing from. Note that priorities are not globally ordered
+/// across workers.
+///
+/// \sa qtPooledObject
+class QTE_EXPORT qtThreadPool
+{
+public:
+  /// Priority of a task.
+  enum Priority
+  {
+    LowPriority,
+    NormalPriority,
+    HighPriority
+  };
+
+  /// Construct a thread pool.
+  ///
+  /// If \p threadCount is less than 1, QThread::idealThreadCount() is used.
+  explicit qtThreadPool(int threadCount = -1);
+
+  /// Destructor.
+  ///
+  /// The destructor waits for all queued tasks to complete before the worker
+  /// threads are stopped.
+  ~qtThreadPool();
+
+  /// Get the shared application thread pool.
+  static qtThreadPool* globalInstance();
+
+  /// Get the number of worker threads.
+  int threadCount() const;
+
+  /// Queue a task for execution.
+  ///
+  /// This queues \p task for execution by a worker thread. The task must not
+  /// throw; use submit() if the task may throw, or if the caller needs to
+  /// know when it has completed.
+  void post(std::function<void()> task, Priority priority = NormalPriority);
+
+  /// Queue a task for execution, and return a future for its result.
+  ///
+  /// This queues \p function for execution by a worker thread. The returned
+  /// future may be used to wait for the function to complete and obtain its
+  /// result (or any exception it throws).
+  template <typename Function>
+  std::future<decltype(std::declval<Function&>()())>
+  submit(Function function, Priority priority = NormalPriority);
+
+  /// Wait for all queued tasks to complete.
+  ///
+  /// This blocks the caller until there are no queued or running tasks. It
+  /// must not be called from a worker thread of the same pool.
+  void waitForDone();
+
+protected:
+  QTE_DECLARE_PRIVATE_RPTR(qtThreadPool)
+
+private:
+  QTE_DECLARE_PRIVATE(qtThreadPool)
+  QTE_DISABLE_COPY(qtThreadPool)
+};
+
+//-----------------------------------------------------------------------------
+template <typename Function>
+std::future<decltype(std::declval<Function&>()())>
+qtThreadPool::submit(Function function, Priority priority)
+{
+  using Result = decltype(std::declval<Function&>()());
+
+  // std::function requires a copyable target, so share the packaged task
+  auto const task =
+    std::make_shared<std::packaged_task<Result()>>(std::move(function));
+  auto future = task->get_future();
+
+  this->post([task]{ (*task)(); }, priority);
+  return future;
+}
+
+//-----------------------------------------------------------------------------
+/// Serial task queue executed by a qtThreadPool.
+///
+/// qtThreadPoolQueue executes tasks in the order they are posted, one at a
+/// time, using the workers of a thread pool. Unlike a dedicated thread, the
+/// queue does not occupy a thread while it has no work.
+///
+/// \sa qtPooledObject
+class QTE_EXPORT qtThreadPoolQueue
+{
+public:
+  /// Construct a queue executing on \p pool.
+  ///
+  /// If \p pool is null, the global thread pool is used.
+  explicit qtThreadPoolQueue(
+    qtThreadPool* pool = 0,
+    qtThreadPool::Priority priority = qtThreadPool::NormalPriority);
+
+  /// Destructor.
+  ///
+  /// The destructor waits for all queued tasks to complete.
+  ~qtThreadPoolQueue();
+
+  /// Queue a task for execution.
+  ///
+  /// The task will execute after all tasks previously posted to this queue
+  /// have completed. The task must not throw.
+  void post(std::function<void()> task);
+
+  /// Wait for all queued tasks to complete.
+  void waitForDone();
+
+  /// Test if the calling thread is currently executing a task of this queue.
+  bool isCurrent() const;
+
+protected:
+  QTE_DECLARE_PRIVATE_SPTR(qtThreadPoolQueue)
+
+private:
+  QTE_DECLARE_PRIVATE(qtThreadPoolQueue)
+  QTE_DISABLE_COPY(qtThreadPoolQueue)
+};
+
+//-----------------------------------------------------------------------------
+/// Template class to wrap a QObject subclass in a pooled task queue.
+///
+/// The qtPooledObject template class is an alternative to
+/// qtInternallyThreadedObject for objects that only occasionally have work
+/// to do. Rather than owning a thread, the object owns a qtThreadPoolQueue,
+/// and work is dispatched to the queue using postWork(). Work items execute
+/// one at a time, in order, on the workers of a thread pool, so that the
+/// work of a single object never executes concurrently with itself.
+///
+/// The QObject itself continues to live in the thread that created it; that
+/// is, slots invoked via queued connections execute in the creating thread.
+/// Such slots should use postWork() to move their work to the pool.
+///
+/// \sa qtThreadPool, qtInternallyThreadedObject
+template <typename T>
+class qtPooledObject : public T
+{
+protected:
+  /// Constructs the pooled object.
+  ///
+  /// If \p pool is null, the global thread pool is used.
+  explicit qtPooledObject(qtThreadPool* pool = 0) : workQueue(pool) {}
+
+public:
+  /// Destructor.
+  ///
+  /// The destructor waits for all posted work to complete. Subclasses whose
+  /// work accesses subclass members should call waitForWork() in their own
+  /// destructor.
+  ~qtPooledObject() { this->workQueue.waitForDone(); }
+
+protected:
+  /// Queue work for execution on the thread pool.
+  void postWork(std::function<void()> work)
+  { this->workQueue.post(std::move(work)); }
+
+  /// Wait for all posted work to complete.
+  void waitForWork() { this->workQueue.waitForDone(); }
+
+  /// Test if the calling thread is executing this object's work.
+  bool isInWorkContext() const { return this->workQueue.isCurrent(); }
+
+private:
+  qtThreadPoolQueue workQueue;
+};
+
+#endif
@@ -7,19 +7,79 @@
 #include "../core/qtIndexRange.h"
 #include "../core/qtScopedValueChange.h"
 
+#include <QAbstractListModel>
+#include <QItemSelectionModel>
+
 QTE_IMPLEMENT_D_FUNC(qtAbstractListDelegate)
 
+namespace // anonymous
+{
+
 //-----------------------------------------------------------------------------
-class qtAbstractListDelegatePrivate
+class MappingModel : public QAbstractListModel
 {
 public:
+  MappingModel(QObject* parent) : QAbstractListModel(parent) {}
+
+  virtual int rowCount(const QModelIndex& parent) const QTE_OVERRIDE
+  {
+    return (parent.isValid() ? 0 : this->names.count());
+  }
+
+  virtual QVariant data(const QModelIndex& index, int role) const QTE_OVERRIDE
+  {
+    if (index.isValid() && index.row() < this->names.count())
+      {
+      switch (role)
+        {
+        case Qt::DisplayRole:
+        case Qt::EditRole:
+          return this->names[index.row()];
+        case Qt::UserRole:
+          return this->values[index.row()];
+        default:
+          break;
+        }
+      }
+    return QVariant();
+  }
+
+  void setMapping(const QStringList& newNames, const QVariantList& newValues)
+  {
+    this->beginResetModel();
+    this->names = newNames;
+    this->values = newValues;
+    this->rowIndex.clear();
+    this->rowIndex.reserve(newValues.count());
+    foreach (auto const i, qtIndexRange(newValues.count()))
+      this->rowIndex.insert(newValues[i].toString(), i);
+    this->endResetModel();
+  }
+
   QStringList names;
+  QVariantList values;
+
+  // Index of rows by string representation of value; used to find candidate
+  // rows for a value without comparing every entry
+  QMultiHash<QString, int> rowIndex;
+};
+
+} // namespace <anonymous>
+
+//-----------------------------------------------------------------------------
+class qtAbstractListDelegatePrivate
+{
+public:
+  qtAbstractListDelegatePrivate(QObject* q) : model(new MappingModel(q)) {}
+
   QHash<QString, QVariant> dataMap;
+  MappingModel* const model;
 };
 
 //-----------------------------------------------------------------------------
 qtAbstractListDelegate::qtAbstractListDelegate(QObject* parent)
-  : QStyledItemDelegate(parent), d_ptr(new qtAbstractListDelegatePrivate)
+  : QStyledItemDelegate(parent),
+    d_ptr(new qtAbstractListDelegatePrivate(this))
 {
 }
 
@@ -33,13 +93,19 @@ void qtAbstractListDelegate::setMapping(
   QStringList names, QVariantList values)
 {
   QTE_D(qtAbstractListDelegate);
-  d->names = names;
   d->dataMap.clear();
+  d->dataMap.reserve(names.count());
+
+  QVariantList data;
+  data.reserve(names.count());
   foreach (auto const i, qtIndexRange(names.count()))
     {
     QVariant v = (i < values.count() ? values[i] : QVariant(i));
     d->dataMap.insert(names[i], v);
+    data.append(v);
     }
+
+  d->model->setMapping(names, data);
 }
 
 //-----------------------------------------------------------------------------
@@ -53,7 +119,7 @@ bool qtAbstractListDelegate::compareData(
 QStringList qtAbstractListDelegate::valueNames() const
 {
   QTE_D_CONST(qtAbstractListDelegate);
-  return d->names;
+  return d->model->names;
 }
 
 //-----------------------------------------------------------------------------
@@ -63,6 +129,52 @@ QVariant qtAbstractListDelegate::valueData(const QString& name) const
   return d->dataMap.value(name);
 }
 
+//-----------------------------------------------------------------------------
+QAbstractItemModel* qtAbstractListDelegate::valueModel() const
+{
+  QTE_D_CONST(qtAbstractListDelegate);
+  return d->model;
+}
+
+//-----------------------------------------------------------------------------
+int qtAbstractListDelegate::valueRow(const QVariant& value) const
+{
+  QTE_D_CONST(qtAbstractListDelegate);
+
+  auto const& values = d->model->values;
+
+  // Check rows whose value has the same string representation first; values
+  // that compare equal usually (but, depending on compareData, not
+  // necessarily) have the same string representation
+  auto const key = value.toString();
+  auto result = -1;
+  auto iter = d->model->rowIndex.constFind(key);
+  while (iter != d->model->rowIndex.constEnd() && iter.key() == key)
+    {
+    auto const i = iter.value();
+    if ((result < 0 || i < result) && this->compareData(value, values[i]))
+      {
+      result = i;
+      }
+    ++iter;
+    }
+  if (result >= 0 || !value.isValid())
+    {
+    return result;
+    }
+
+  // Fall back to comparing all entries
+  foreach (auto const i, qtIndexRange(values.count()))
+    {
+    if (this->compareData(value, values[i]))
+      {
+      return i;
+      }
+    }
+
+  return -1;
+}
+
 //-----------------------------------------------------------------------------
 QWidget* qtAbstractListDelegate::createEditor(
   QWidget* parent, const QStyleOptionViewItem&, const QModelIndex&) const
@@ -107,8 +219,14 @@ void qtAbstractListDelegate::setModelData(
 //-----------------------------------------------------------------------------
 void qtAbstractListDelegate::editorValueChanged()
 {
-  // Get the editor
-  QWidget* editor = qobject_cast<QWidget*>(this->sender());
+  // Get the editor; item view editors report changes via their selection
+  // model, which is owned by the view
+  QObject* source = this->sender();
+  if (qobject_cast<QItemSelectionModel*>(source))
+    {
+    source = source->parent();
+    }
+  QWidget* editor = qobject_cast<QWidget*>(source);
   if (!editor)
     {
     return;
@@ -38,6 +38,23 @@ protected:
   QStringList valueNames() const;
   QVariant valueData(const QString&) const;
 
+  /// Get model of mapping entries.
+  ///
+  /// This returns a list model containing the entries set by setMapping(),
+  /// with the name in the Qt::DisplayRole and the value in the Qt::UserRole.
+  /// The model is shared by all editors created by the delegate, so that
+  /// creating an editor does not require copying the entries.
+  QAbstractItemModel* valueModel() const;
+
+  /// Get row of value in the model of mapping entries.
+  ///
+  /// This returns the first row of valueModel() whose value compares equal
+  /// to \p value (according to compareData()), or -1 if there is no such row.
+  /// The row is found by a hash lookup, except when no entry has the same
+  /// string representation as \p value, in which case all entries are
+  /// compared (unless \p value is invalid).
+  int valueRow(const QVariant& value) const;
+
   virtual void setModelData(QWidget* editor, const QString& text,
                             const QVariant& data, QAbstractItemModel* model,
                             const QModelIndex& index) const;
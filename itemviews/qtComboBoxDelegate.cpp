@@ -4,8 +4,6 @@
 
 #include "qtComboBoxDelegate.h"
 
-#include "../core/qtIndexRange.h"
-
 #include <QComboBox>
 
 //-----------------------------------------------------------------------------
@@ -22,16 +20,13 @@ qtComboBoxDelegate::~qtComboBoxDelegate()
 //-----------------------------------------------------------------------------
 QWidget* qtComboBoxDelegate::createListEditor(QWidget* parent) const
 {
-  // Create combo box
+  // Create combo box, using the shared model of mapping entries
   QComboBox* box = new QComboBox(parent);
   box->setFocusPolicy(Qt::StrongFocus);
+  box->setModel(this->valueModel());
   connect(box, SIGNAL(currentIndexChanged(int)),
           this, SLOT(editorValueChanged()));
 
-  // Fill combo box
-  foreach (auto const& name, this->valueNames())
-    box->addItem(name, this->valueData(name));
-
   // Flag box to show pop-up once we know the geometry
   box->setProperty("firstShow", true);
 
@@ -44,17 +39,7 @@ void qtComboBoxDelegate::setListEditorData(
   QWidget* editor, const QVariant& newData) const
 {
   QComboBox* box = qobject_cast<QComboBox*>(editor);
-
-  int i = -1;
-  foreach (int const j, qtIndexRange(box->count()))
-    {
-    if (this->compareData(newData, box->itemData(j)))
-      {
-      i = j;
-      break;
-      }
-    }
-  box->setCurrentIndex(i);
+  box->setCurrentIndex(this->valueRow(newData));
 }
 
 //-----------------------------------------------------------------------------
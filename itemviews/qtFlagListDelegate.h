@@ -24,6 +24,7 @@ public:
 protected:
   using qtListDelegate::setModelData;
 
+  virtual QWidget* createListEditor(QWidget* parent) const;
   virtual QListWidgetItem* createListItem(const QString& name,
                                           const QVariant& data) const;
   virtual void setListEditorData(QWidget* editor, const QVariant&) const;
@@ -34,6 +35,15 @@ private:
   QTE_DISABLE_COPY(qtFlagListDelegate);
 };
 
+//-----------------------------------------------------------------------------
+template <typename Flag, typename Flags>
+QWidget* qtFlagListDelegate<Flag, Flags>::createListEditor(
+  QWidget* parent) const
+{
+  // Check states are per-editor, so the shared model cannot be used
+  return this->createListWidget(parent);
+}
+
 //-----------------------------------------------------------------------------
 template <typename Flag, typename Flags>
 QListWidgetItem* qtFlagListDelegate<Flag, Flags>::createListItem(
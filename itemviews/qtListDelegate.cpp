@@ -4,11 +4,25 @@
 
 #include "qtListDelegate.h"
 
-#include "../core/qtIndexRange.h"
-
 #include <QEvent>
 #include <QListWidget>
 
+namespace // anonymous
+{
+
+//-----------------------------------------------------------------------------
+void setMinimumListSize(QListView* list)
+{
+  // Set a reasonable minimum size
+  int rowHeight = list->sizeHintForRow(0);
+  int showRows = qMin(list->model()->rowCount(), 6);
+  int margin = 4 * list->style()->pixelMetric(QStyle::PM_DefaultFrameWidth);
+  list->setMinimumHeight((showRows * rowHeight) + margin + 2);
+  list->setMinimumWidth(list->minimumSizeHint().width());
+}
+
+} // namespace <anonymous>
+
 //-----------------------------------------------------------------------------
 qtListDelegate::qtListDelegate(QObject* parent)
   : qtAbstractListDelegate(parent)
@@ -22,6 +36,23 @@ qtListDelegate::~qtListDelegate()
 
 //-----------------------------------------------------------------------------
 QWidget* qtListDelegate::createListEditor(QWidget* parent) const
+{
+  // Create list view, using the shared model of mapping entries
+  QListView* list = new QListView(parent);
+  list->setUniformItemSizes(true);
+  list->setModel(this->valueModel());
+  connect(list->selectionModel(),
+          SIGNAL(currentRowChanged(QModelIndex, QModelIndex)),
+          this, SLOT(editorValueChanged()));
+
+  setMinimumListSize(list);
+
+  // Done
+  return list;
+}
+
+//-----------------------------------------------------------------------------
+QListWidget* qtListDelegate::createListWidget(QWidget* parent) const
 {
   // Create list widget
   QListWidget* list = new QListWidget(parent);
@@ -29,16 +60,10 @@ QWidget* qtListDelegate::createListEditor(QWidget* parent) const
           this, SLOT(editorValueChanged()));
 
   // Fill list widget
-  QStringList names = this->valueNames();
-  foreach (auto const& name, names)
+  foreach (auto const& name, this->valueNames())
     list->addItem(this->createListItem(name, this->valueData(name)));
 
-  // Set a reasonable minimum size
-  int rowHeight = list->sizeHintForRow(0);
-  int showRows = qMin(names.count(), 6);
-  int margin = 4 * list->style()->pixelMetric(QStyle::PM_DefaultFrameWidth);
-  list->setMinimumHeight((showRows * rowHeight) + margin + 2);
-  list->setMinimumWidth(list->minimumSizeHint().width());
+  setMinimumListSize(list);
 
   // Done
   return list;
@@ -58,30 +83,21 @@ QListWidgetItem* qtListDelegate::createListItem(
 void qtListDelegate::setListEditorData(
   QWidget* editor, const QVariant& newData) const
 {
-  QListWidget* list = qobject_cast<QListWidget*>(editor);
-
-  int i = -1;
-  foreach (int const j, qtIndexRange(list->count()))
-    {
-    if (this->compareData(newData, list->item(j)->data(Qt::UserRole)))
-      {
-      i = j;
-      break;
-      }
-    }
-  list->setCurrentRow(i);
+  QListView* list = qobject_cast<QListView*>(editor);
+  int const row = this->valueRow(newData);
+  list->setCurrentIndex(list->model()->index(row, 0));
 }
 
 //-----------------------------------------------------------------------------
 void qtListDelegate::setModelData(
   QWidget* editor, QAbstractItemModel* model, const QModelIndex& index) const
 {
-  QListWidget* list = qobject_cast<QListWidget*>(editor);
-  QListWidgetItem* item = list->currentItem();
-  if (item)
+  QListView* list = qobject_cast<QListView*>(editor);
+  QModelIndex const current = list->currentIndex();
+  if (current.isValid())
     {
-    this->setModelData(editor, item->text(), item->data(Qt::UserRole),
-                       model, index);
+    this->setModelData(editor, current.data(Qt::DisplayRole).toString(),
+                       current.data(Qt::UserRole), model, index);
     }
 }
 
@@ -7,6 +7,7 @@
 
 #include "qtAbstractListDelegate.h"
 
+class QListWidget;
 class QListWidgetItem;
 
 class QTE_EXPORT qtListDelegate : public qtAbstractListDelegate
@@ -27,6 +28,22 @@ protected:
   using qtAbstractListDelegate::setModelData;
 
   virtual QWidget* createListEditor(QWidget* parent) const;
+
+  /// Create list widget editor.
+  ///
+  /// The default editor is a list view of the shared model of mapping
+  /// entries. This instead creates a QListWidget having a separate item for
+  /// each entry, as created by createListItem(), for subclasses that need
+  /// per-editor item state (e.g. check states). Such subclasses should
+  /// override createListEditor() to call this method.
+  QListWidget* createListWidget(QWidget* parent) const;
+
+  /// Create list widget item.
+  ///
+  /// This is called only by createListWidget(). The default editor does not
+  /// use it, nor is the default editor a QListWidget, so subclasses that
+  /// override this method, or that cast the editor to QListWidget, must also
+  /// override createListEditor() to call createListWidget().
   virtual QListWidgetItem* createListItem(const QString& name,
                                           const QVariant& data) const;
   virtual void setListEditorData(QWidget* editor, const QVariant&) const;
@@ -4,14 +4,49 @@
 
 #include "qtRichTextDelegate.h"
 
+#include <QAbstractItemModel>
 #include <QAbstractTextDocumentLayout>
 #include <QApplication>
+#include <QCache>
+#include <QHash>
 #include <QPainter>
+#include <QSet>
 #include <QTextDocument>
 
+QTE_IMPLEMENT_D_FUNC(qtRichTextDelegate)
+
 namespace // anonymous
 {
 
+//-----------------------------------------------------------------------------
+struct LayoutKey
+{
+  QString text;
+  QString font;
+  int width;
+
+  bool operator==(LayoutKey const& other) const
+  {
+    return this->width == other.width && this->text == other.text &&
+           this->font == other.font;
+  }
+};
+
+//-----------------------------------------------------------------------------
+uint qHash(LayoutKey const& key, uint seed = 0)
+{
+  seed = ::qHash(key.text, seed);
+  seed = ::qHash(key.font, seed);
+  return seed ^ ::qHash(key.width);
+}
+
+//-----------------------------------------------------------------------------
+struct Layout
+{
+  QTextDocument document;
+  QSize size;
+};
+
 //-----------------------------------------------------------------------------
 int itemMargin(const QStyleOptionViewItem& opt)
 {
@@ -30,9 +65,81 @@ void buildItemDocument(QTextDocument& doc, const QStyleOptionViewItem& opt)
 
 } // namespace <anonymous>
 
+//-----------------------------------------------------------------------------
+class qtRichTextDelegatePrivate
+{
+public:
+  qtRichTextDelegatePrivate(qtRichTextDelegate* q) : q_ptr(q), cache(512) {}
+
+  Layout* layout(const QStyleOptionViewItem& opt,
+                 const QModelIndex& index) const;
+
+  mutable QCache<LayoutKey, Layout> cache;
+  mutable QScopedPointer<Layout> uncached;
+  mutable QSet<QAbstractItemModel const*> models;
+
+protected:
+  QTE_DECLARE_PUBLIC_PTR(qtRichTextDelegate)
+
+private:
+  QTE_DECLARE_PUBLIC(qtRichTextDelegate)
+};
+
+//-----------------------------------------------------------------------------
+Layout* qtRichTextDelegatePrivate::layout(
+  const QStyleOptionViewItem& opt, const QModelIndex& index) const
+{
+  // Clear the cache when a model's data changes; this keeps entries for stale
+  // text from crowding out current entries
+  auto const* const model = index.model();
+  if (model && !this->models.contains(model))
+    {
+    QTE_Q_CONST(qtRichTextDelegate);
+
+    auto const clear = [this]{ this->cache.clear(); };
+    auto const forget = [this, model]{
+      this->models.remove(model);
+      this->cache.clear();
+    };
+
+    this->models.insert(model);
+    QObject::connect(model, &QAbstractItemModel::dataChanged, q, clear);
+    QObject::connect(model, &QAbstractItemModel::modelReset, q, clear);
+    QObject::connect(model, &QObject::destroyed, q, forget);
+    }
+
+  // Look up the layout; the text, font, and available width fully determine
+  // the layout (the selection state only affects the palette, which is
+  // applied when painting), so items showing the same text share an entry
+  auto const width = opt.rect.width() - (2 * itemMargin(opt));
+  auto const key = LayoutKey{opt.text, opt.font.key(), width};
+  if (auto* const entry = this->cache.object(key))
+    {
+    return entry;
+    }
+
+  auto* const entry = new Layout;
+  buildItemDocument(entry->document, opt);
+
+  auto const& doc = entry->document;
+  auto const documentSize = QSizeF{doc.idealWidth(), doc.size().height()};
+  entry->size = documentSize.toSize();
+
+  // QCache deletes objects that it cannot hold, so keep the layout elsewhere
+  // if caching is disabled
+  if (this->cache.maxCost() < 1)
+    {
+    this->uncached.reset(entry);
+    return entry;
+    }
+
+  this->cache.insert(key, entry);
+  return entry;
+}
+
 //-----------------------------------------------------------------------------
 qtRichTextDelegate::qtRichTextDelegate(QObject* parent) :
-  QStyledItemDelegate(parent)
+  QStyledItemDelegate(parent), d_ptr(new qtRichTextDelegatePrivate(this))
 {
 }
 
@@ -41,20 +148,42 @@ qtRichTextDelegate::~qtRichTextDelegate()
 {
 }
 
+//-----------------------------------------------------------------------------
+int qtRichTextDelegate::cacheSize() const
+{
+  QTE_D_CONST(qtRichTextDelegate);
+  return d->cache.maxCost();
+}
+
+//-----------------------------------------------------------------------------
+void qtRichTextDelegate::setCacheSize(int size)
+{
+  QTE_D(qtRichTextDelegate);
+  d->cache.setMaxCost(size);
+}
+
+//-----------------------------------------------------------------------------
+void qtRichTextDelegate::clearCache()
+{
+  QTE_D(qtRichTextDelegate);
+  d->cache.clear();
+}
+
 //-----------------------------------------------------------------------------
 void qtRichTextDelegate::paint(
   QPainter* painter, const QStyleOptionViewItem& option,
   const QModelIndex& index) const
 {
+  QTE_D_CONST(qtRichTextDelegate);
+
   QStyleOptionViewItem opt = option;
   this->initStyleOption(&opt, index);
 
   QStyle* const style =
     (opt.widget ? opt.widget->style() : QApplication::style());
 
-  // Build HTML document from text
-  QTextDocument doc;
-  buildItemDocument(doc, opt);
+  // Get HTML document for text
+  auto* const layout = d->layout(opt, index);
 
   // Paint item without text
   opt.text.clear();
@@ -76,7 +205,7 @@ void qtRichTextDelegate::paint(
   painter->save();
   painter->translate(textRect.topLeft());
   painter->setClipRect(textRect.translated(-textRect.topLeft()));
-  doc.documentLayout()->draw(painter, ctx);
+  layout->document.documentLayout()->draw(painter, ctx);
   painter->restore();
 }
 
@@ -84,16 +213,14 @@ void qtRichTextDelegate::paint(
 QSize qtRichTextDelegate::sizeHint(
   const QStyleOptionViewItem& option, const QModelIndex& index) const
 {
+  QTE_D_CONST(qtRichTextDelegate);
+
   QStyleOptionViewItem opt = option;
   this->initStyleOption(&opt, index);
 
-  // Build HTML document from text
-  QTextDocument doc;
-  buildItemDocument(doc, opt);
-
-  // Get document size
-  auto const documentSize = QSizeF{doc.idealWidth(), doc.size().height()};
+  // Get HTML document size for text
+  auto* const layout = d->layout(opt, index);
 
   // Return document size adjusted by item margin
-  return documentSize.toSize() + QSize{2 * itemMargin(opt), 0};
+  return layout->size + QSize{2 * itemMargin(opt), 0};
 }
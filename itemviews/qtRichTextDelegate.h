@@ -9,6 +9,8 @@
 
 #include "../core/qtGlobal.h"
 
+class qtRichTextDelegatePrivate;
+
 class QTE_EXPORT qtRichTextDelegate : public QStyledItemDelegate
 {
   Q_OBJECT
@@ -17,13 +19,32 @@ public:
   qtRichTextDelegate(QObject* parent = 0);
   virtual ~qtRichTextDelegate();
 
+  /// Get maximum number of cached text layouts.
+  int cacheSize() const;
+
+  /// Set maximum number of cached text layouts.
+  ///
+  /// The delegate keeps the laid-out documents of recently painted or
+  /// measured items, so that they need not be rebuilt from HTML when the same
+  /// text is shown again at the same width (e.g. when scrolling). The least
+  /// recently used layouts are discarded when the cache is full. The cache is
+  /// also cleared when the data of any model that the delegate has been used
+  /// with changes.
+  void setCacheSize(int);
+
+  /// Discard all cached text layouts.
+  void clearCache();
+
 protected:
+  QTE_DECLARE_PRIVATE_RPTR(qtRichTextDelegate)
+
   virtual void paint(QPainter* painter, const QStyleOptionViewItem& option,
                      const QModelIndex& index) const QTE_OVERRIDE;
   virtual QSize sizeHint(const QStyleOptionViewItem& option,
                          const QModelIndex& index) const QTE_OVERRIDE;
 
 private:
+  QTE_DECLARE_PRIVATE(qtRichTextDelegate)
   QTE_DISABLE_COPY(qtRichTextDelegate);
 };
 
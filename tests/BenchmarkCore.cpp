@@ -0,0 +1,81 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#define TEST_OBJECT_NAME t_obj
+
+#include "../core/qtChannel.h"
+#include "../core/qtOnce.h"
+#include "../core/qtTest.h"
+#include "../core/qtThreadPool.h"
+
+#include <QAtomicInt>
+
+QTE_BENCHMARK_ALLOCATION_HOOK;
+
+//-----------------------------------------------------------------------------
+int testOnce(qtTest& t_obj)
+{
+    static qtOnceFlag flag;
+    auto calls = 0;
+
+    TEST_BENCHMARK("qtOnce (initialized)")
+    {
+        qtOnce(flag, [&calls]{ ++calls; });
+    }
+    TEST_EQUAL(calls, 1);
+
+    static qtLazy<int> lazy;
+    TEST_BENCHMARK("qtLazy::get (initialized)")
+    {
+        qtTestBenchmark::keep(lazy.get());
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int testChannel(qtTest& t_obj)
+{
+    qtSpscChannel<int> channel{64};
+    auto sum = 0ll;
+
+    TEST_BENCHMARK("qtSpscChannel push/pop")
+    {
+        int value;
+        channel.tryPush(1);
+        channel.tryPop(value);
+        sum += value;
+    }
+    TEST(sum > 0);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int testThreadPool(qtTest& t_obj)
+{
+    qtThreadPool pool;
+    QAtomicInt count{0};
+
+    TEST_BENCHMARK("qtThreadPool post (batch of 100)")
+    {
+        for (int i = 0; i < 100; ++i)
+            pool.post([&count]{ count.ref(); });
+        pool.waitForDone();
+    }
+    TEST(count.load() > 0);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int main()
+{
+  qtTest t_obj;
+
+  t_obj.runSuite("Once", testOnce);
+  t_obj.runSuite("Channel", testChannel);
+  t_obj.runSuite("Thread Pool", testThreadPool);
+  return t_obj.result();
+}
@@ -0,0 +1,139 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#define TEST_OBJECT_NAME t_obj
+
+#include "../core/qtTest.h"
+#include "../util/qtAnimationDriver.h"
+
+#include <QApplication>
+#include <QEventLoop>
+#include <QSet>
+#include <QTimer>
+#include <QVariantAnimation>
+#include <QWidget>
+
+namespace // anonymous
+{
+
+//-----------------------------------------------------------------------------
+class PaintCounter : public QWidget
+{
+public:
+    int paintCount = 0;
+
+protected:
+    void paintEvent(QPaintEvent*) override { ++this->paintCount; }
+};
+
+} // namespace <anonymous>
+
+//-----------------------------------------------------------------------------
+int testFrames(qtTest& t_obj)
+{
+    PaintCounter widget;
+    widget.resize(64, 64);
+    widget.show();
+    QCoreApplication::processEvents();
+
+    qtAnimationDriver driver;
+    driver.setFrameRate(50.0);
+    driver.install();
+    TEST(driver.isInstalled());
+    TEST(qtAnimationDriver::current() == &driver);
+
+    // Count frames, and the paint events of the widget in each frame; the
+    // paint for a frame happens after the frame has finished, so it is
+    // counted when the next frame finishes
+    auto frames = 0;
+    auto maxPaintsPerFrame = 0;
+    auto paintsAtLastFrame = widget.paintCount;
+    QObject::connect(&driver, &qtAnimationDriver::frameFinished, [&]{
+        ++frames;
+        auto const paints = widget.paintCount - paintsAtLastFrame;
+        maxPaintsPerFrame = qMax(maxPaintsPerFrame, paints);
+        paintsAtLastFrame = widget.paintCount;
+    });
+
+    // Run two animations, which both request updates of the widget (each
+    // more than once) whenever they advance; record the frames in which each
+    // animation advanced
+    QVariantAnimation a, b;
+    QSet<int> aFrames, bFrames;
+    for (auto* const animation : {&a, &b})
+    {
+        animation->setStartValue(0.0);
+        animation->setEndValue(1.0);
+    }
+    a.setDuration(300);
+    b.setDuration(400);
+
+    QObject::connect(&a, &QVariantAnimation::valueChanged, [&]{
+        aFrames.insert(frames);
+        qtAnimationDriver::scheduleUpdate(&widget);
+        qtAnimationDriver::scheduleUpdate(&widget);
+    });
+    QObject::connect(&b, &QVariantAnimation::valueChanged, [&]{
+        bFrames.insert(frames);
+        qtAnimationDriver::scheduleUpdate(&widget);
+    });
+
+    QEventLoop loop;
+    QObject::connect(&b, &QAbstractAnimation::finished,
+                     &loop, &QEventLoop::quit);
+    QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+
+    a.start();
+    b.start();
+    loop.exec();
+
+    TEST_EQUAL(a.state(), QAbstractAnimation::Stopped);
+    TEST_EQUAL(b.state(), QAbstractAnimation::Stopped);
+
+    // At 50 frames per second, the animations should take about 20 frames;
+    // allow for a heavily loaded machine, but require several frames
+    auto const statistics = driver.statistics();
+    TEST(statistics.frameCount >= 5);
+    TEST_EQUAL(frames, statistics.frameCount);
+    TEST(statistics.meanInterval > 0.0);
+    TEST(statistics.maxInterval >= statistics.meanInterval);
+    TEST(statistics.maxFrameTime >= statistics.meanFrameTime);
+
+    // Both animations advance in the same frames, for as long as both run
+    auto const* const first = (aFrames.count() < bFrames.count()
+                               ? &aFrames : &bFrames);
+    auto const* const second = (first == &aFrames ? &bFrames : &aFrames);
+    TEST(!first->isEmpty());
+    TEST(second->contains(*first));
+
+    // Updates requested in a frame are combined, so the widget is painted at
+    // most once per frame, despite three requests
+    TEST(widget.paintCount > 0);
+    TEST(maxPaintsPerFrame <= 1);
+
+    // The clock stops when no animations are running (Qt may deliver one more
+    // frame while it notices that the last animation has stopped)
+    QTimer::singleShot(200, &loop, &QEventLoop::quit);
+    loop.exec();
+    TEST(driver.statistics().frameCount <= statistics.frameCount + 1);
+
+    driver.resetStatistics();
+    TEST_EQUAL(driver.statistics().frameCount, 0);
+
+    driver.uninstall();
+    TEST(!driver.isInstalled());
+    TEST(!qtAnimationDriver::current());
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    QApplication app(argc, argv); // Needed to construct widgets
+    qtTest t_obj;
+
+    t_obj.runSuite("Frames", testFrames);
+    return t_obj.result();
+}
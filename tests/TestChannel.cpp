@@ -0,0 +1,111 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#define TEST_OBJECT_NAME t_obj
+
+#include "../core/qtChannel.h"
+#include "../core/qtTest.h"
+#include "../core/qtThreadPool.h"
+
+#include <QString>
+
+//-----------------------------------------------------------------------------
+int testNonBlocking(qtTest& t_obj)
+{
+    qtSpscChannel<QString> channel{3};
+    TEST_EQUAL(channel.capacity(), size_t{4});
+
+    TEST(channel.tryPush("a"));
+    TEST(channel.tryPush("b"));
+    TEST(channel.tryPush("c"));
+    TEST(channel.tryPush("d"));
+    TEST(!channel.tryPush("e"));
+
+    QString s;
+    TEST(channel.tryPop(s));
+    TEST_EQUAL(s, QString{"a"});
+    TEST(channel.tryPush("e"));
+
+    channel.close();
+    TEST(!channel.tryPush("f"));
+
+    QString all;
+    while (channel.pop(s))
+        all += s;
+    TEST_EQUAL(all, QString{"bcde"});
+    TEST(!channel.tryPop(s));
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int testSpsc(qtTest& t_obj)
+{
+    qtThreadPool pool{1};
+    qtSpscChannel<long long> channel{64};
+
+    auto const count = 1000000ll;
+    pool.post([&channel, count]{
+        for (auto i = 0ll; i < count; ++i)
+            channel.push(i);
+        channel.close();
+    });
+
+    auto sum = 0ll;
+    auto ordered = true;
+    auto expected = 0ll;
+    long long value;
+    while (channel.pop(value))
+    {
+        ordered = ordered && (value == expected++);
+        sum += value;
+    }
+
+    TEST(ordered);
+    TEST_EQUAL(sum, count * (count - 1) / 2);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int testMpsc(qtTest& t_obj)
+{
+    qtThreadPool pool{4};
+    qtMpscChannel<long long> channel{64};
+
+    auto const count = 250000ll;
+    for (int n = 0; n < 4; ++n)
+    {
+        pool.post([&channel, count]{
+            for (auto i = 0ll; i < count; ++i)
+                channel.push(i);
+        });
+    }
+
+    auto sum = 0ll;
+    auto received = 0ll;
+    long long value;
+    while (received < 4 * count && channel.pop(value, 5000))
+    {
+        sum += value;
+        ++received;
+    }
+
+    TEST_EQUAL(received, 4 * count);
+    TEST_EQUAL(sum, 4 * (count * (count - 1) / 2));
+    TEST(!channel.pop(value, 10));
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int main()
+{
+  qtTest t_obj;
+
+  t_obj.runSuite("Non-blocking Operations", testNonBlocking);
+  t_obj.runSuite("Single Producer", testSpsc);
+  t_obj.runSuite("Multiple Producers", testMpsc);
+  return t_obj.result();
+}
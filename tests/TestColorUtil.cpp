@@ -0,0 +1,131 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#define TEST_OBJECT_NAME t_obj
+
+#include "../core/qtTest.h"
+#include "../util/qtColorUtil.h"
+
+#include <QList>
+
+namespace // anonymous
+{
+
+//-----------------------------------------------------------------------------
+bool closeColor(QRgb a, QRgb b, int tolerance)
+{
+    return qAbs(qRed(a) - qRed(b)) <= tolerance &&
+           qAbs(qGreen(a) - qGreen(b)) <= tolerance &&
+           qAbs(qBlue(a) - qBlue(b)) <= tolerance &&
+           qAbs(qAlpha(a) - qAlpha(b)) <= tolerance;
+}
+
+//-----------------------------------------------------------------------------
+QList<QColor> testColors()
+{
+    QList<QColor> colors;
+
+    // Sample the RGB cube
+    for (int r = 0; r < 256; r += 17)
+    {
+        for (int g = 0; g < 256; g += 17)
+        {
+            for (int b = 0; b < 256; b += 17)
+                colors.append(QColor{r, g, b, (r + g + b) % 256});
+        }
+    }
+
+    // Add every gray level, which have no hue (and so take a different path
+    // through the conversions)
+    for (int k = 0; k < 256; ++k)
+        colors.append(QColor{k, k, k, 255 - k});
+
+    return colors;
+}
+
+//-----------------------------------------------------------------------------
+int testRoundTrip(qtTest& t_obj, QColor::Spec spec)
+{
+    auto mismatches = 0;
+    foreach (auto const& color, testColors())
+    {
+        auto const& f = qtColorUtil::toFloatColor(color, spec);
+        auto const rgba = qtColorUtil::toRgba(f, spec);
+
+        // Hue, saturation, etc. are stored by QColor with limited precision,
+        // which can move a component across a rounding boundary
+        auto const tolerance = (spec == QColor::Rgb ? 0 : 1);
+        if (!closeColor(rgba, color.rgba(), tolerance))
+        {
+            t_obj.out() << "  " << color.name(QColor::HexArgb)
+                        << " became " << QString::number(rgba, 16) << '\n';
+            ++mismatches;
+        }
+
+        // Conversion through QColor gives the same color
+        auto const& c = qtColorUtil::toColor(f, spec);
+        if (!closeColor(c.rgba(), color.rgba(), tolerance))
+            ++mismatches;
+    }
+    TEST_EQUAL(mismatches, 0);
+
+    return 0;
+}
+
+} // namespace <anonymous>
+
+//-----------------------------------------------------------------------------
+int testRgb(qtTest& t_obj)
+{
+    return testRoundTrip(t_obj, QColor::Rgb);
+}
+
+//-----------------------------------------------------------------------------
+int testHsv(qtTest& t_obj)
+{
+    return testRoundTrip(t_obj, QColor::Hsv);
+}
+
+//-----------------------------------------------------------------------------
+int testHsl(qtTest& t_obj)
+{
+    return testRoundTrip(t_obj, QColor::Hsl);
+}
+
+//-----------------------------------------------------------------------------
+int testAchromatic(qtTest& t_obj)
+{
+    // Gray colors have a hue of -1
+    QColor const gray{128, 128, 128};
+    TEST_EQUAL(qtColorUtil::toFloatColor(gray, QColor::Hsv).v[0], -1.0f);
+    TEST_EQUAL(qtColorUtil::toFloatColor(gray, QColor::Hsl).v[0], -1.0f);
+
+    // Any negative hue (e.g. from blending with a gray color) is achromatic,
+    // regardless of the saturation
+    qtColorUtil::FloatColor const f = {{-0.25f, 0.8f, 0.6f, 1.0f}};
+
+    auto const& hsv = qtColorUtil::toColor(f, QColor::Hsv);
+    TEST_EQUAL(hsv.hsvHueF(), qreal{-1.0});
+    TEST_EQUAL(qtColorUtil::toRgba(f, QColor::Hsv), qRgb(153, 153, 153));
+    TEST_EQUAL(qtColorUtil::toRgba(f, QColor::Hsv), hsv.rgba());
+
+    auto const& hsl = qtColorUtil::toColor(f, QColor::Hsl);
+    TEST_EQUAL(hsl.hslHueF(), qreal{-1.0});
+    TEST_EQUAL(qtColorUtil::toRgba(f, QColor::Hsl), qRgb(153, 153, 153));
+    TEST_EQUAL(qtColorUtil::toRgba(f, QColor::Hsl), hsl.rgba());
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int main()
+{
+    qtTest t_obj;
+
+    t_obj.runSuite("RGB Round Trip", testRgb);
+    t_obj.runSuite("HSV Round Trip", testHsv);
+    t_obj.runSuite("HSL Round Trip", testHsl);
+    t_obj.runSuite("Achromatic Colors", testAchromatic);
+    return t_obj.result();
+}
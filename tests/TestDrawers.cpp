@@ -40,7 +40,7 @@ TestDrawersWidget::TestDrawersWidget(QWidget* parent)
   sac->setLayout(li);
   li->addWidget(this->drawerWidget);
   li->addStretch();
-  lo->addWidget(sa, 0, 0, 1, 3);
+  lo->addWidget(sa, 0, 0, 1, 4);
 
   QToolButton* bar = new QToolButton;
   bar->setIcon(QIcon(":icons/add"));
@@ -49,14 +49,21 @@ TestDrawersWidget::TestDrawersWidget(QWidget* parent)
   lo->addWidget(bar, 1, 0);
   connect(bar, SIGNAL(clicked(bool)), this, SLOT(addRootDrawer()));
 
+  QToolButton* bam = new QToolButton;
+  bam->setIcon(QIcon(":icons/add"));
+  bam->setText("Add many drawers");
+  bam->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
+  lo->addWidget(bam, 1, 1);
+  connect(bam, SIGNAL(clicked(bool)), this, SLOT(addManyDrawers()));
+
   QToolButton* bc = new QToolButton;
   bc->setIcon(QIcon(":icons/clear"));
   bc->setText("Remove all drawers");
   bc->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
-  lo->addWidget(bc, 1, 1);
+  lo->addWidget(bc, 1, 2);
   connect(bc, SIGNAL(clicked(bool)), this, SLOT(clearDrawers()));
 
-  lo->addItem(new QSpacerItem(0, 0, QSizePolicy::Expanding), 1, 2);
+  lo->addItem(new QSpacerItem(0, 0, QSizePolicy::Expanding), 1, 3);
 
   connect(&this->mapAddBefore, SIGNAL(mapped(QWidget*)),
           this, SLOT(addDrawerBefore(QWidget*)));
@@ -80,6 +87,23 @@ void TestDrawersWidget::addRootDrawer()
   this->setupDrawer(d);
 }
 
+//-----------------------------------------------------------------------------
+void TestDrawersWidget::addManyDrawers()
+{
+  // Populate a batch of drawers, each with a few children, in one update
+  this->drawerWidget->beginUpdate();
+  for (int i = 0; i < 100; ++i)
+    {
+    qtDrawer* d = this->drawerWidget->addDrawer();
+    this->setupDrawer(d);
+    for (int j = 0; j < 5; ++j)
+      {
+      this->setupDrawer(new qtDrawer(d));
+      }
+    }
+  this->drawerWidget->endUpdate();
+}
+
 //-----------------------------------------------------------------------------
 void TestDrawersWidget::clearDrawers()
 {
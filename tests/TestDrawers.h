@@ -26,6 +26,7 @@ public slots:
   void addDrawerChild(QWidget*);
   void removeDrawer(QWidget*);
   void addRootDrawer();
+  void addManyDrawers();
   void clearDrawers();
 
 protected:
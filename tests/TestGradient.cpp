@@ -0,0 +1,412 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#define TEST_OBJECT_NAME t_obj
+
+#include "../core/qtTest.h"
+#include "../util/qtColorUtil.h"
+#include "../util/qtGradient.h"
+
+#include <QVector>
+
+#include <cmath>
+#include <limits>
+
+namespace // anonymous
+{
+
+//-----------------------------------------------------------------------------
+bool closeColor(QRgb a, QRgb b, int tolerance)
+{
+    return qAbs(qRed(a) - qRed(b)) <= tolerance &&
+           qAbs(qGreen(a) - qGreen(b)) <= tolerance &&
+           qAbs(qBlue(a) - qBlue(b)) <= tolerance &&
+           qAbs(qAlpha(a) - qAlpha(b)) <= tolerance;
+}
+
+//-----------------------------------------------------------------------------
+QList<qtGradient::Stop> testStops()
+{
+    return {
+        {0.0, QColor{255, 0, 0}, 0.5},
+        {0.3, QColor{0, 200, 0, 128}, 0.3},
+        {0.6, QColor::fromHsv(200, 180, 220), 0.7},
+        {1.0, QColor{40, 0, 255}, 0.5},
+    };
+}
+
+//-----------------------------------------------------------------------------
+// Map a position through a spread mode, independently of qtGradient
+qreal spreadPosition(qreal t, QGradient::Spread spread)
+{
+    switch (spread)
+    {
+        case QGradient::RepeatSpread:
+            return t - std::floor(t);
+        case QGradient::ReflectSpread:
+        {
+            auto const m = t - (2.0 * std::floor(0.5 * t));
+            return (m > 1.0 ? 2.0 - m : m);
+        }
+        default:
+            return qBound(0.0, t, 1.0);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Compute the color of a gradient as qtGradient did before the segment
+// coefficients were precomputed, by blending QColor values for each position
+QColor referenceColorAt(qtGradient const& gradient, qreal pos)
+{
+    auto const stops = gradient.stops();
+    auto const mode = gradient.interpolationMode();
+
+    QColor::Spec space;
+    switch (mode & qtGradient::InterpolateColorspaceMask)
+    {
+        case qtGradient::InterpolateCmyk: space = QColor::Cmyk; break;
+        case qtGradient::InterpolateHsv: space = QColor::Hsv; break;
+        case qtGradient::InterpolateHsl: space = QColor::Hsl; break;
+        default: space = QColor::Rgb; break;
+    }
+
+    auto const su = stops.lowerBound(pos);
+    if (qFuzzyCompare(pos, su.key()))
+        return su->color;
+
+    auto const sl = su - 1;
+    if (qFuzzyCompare(pos, sl.key()))
+        return sl->color;
+
+    auto t = (pos - sl.key()) / (su.key() - sl.key());
+    auto const w = sl->weight;
+
+    if ((mode & qtGradient::InterpolateFunctionMask) ==
+        qtGradient::InterpolateLinear)
+    {
+        t = (t > w ? qtColorUtil::blend(0.5, 1.0, (t - w) / (1.0 - w))
+                   : qtColorUtil::blend(0.0, 0.5, t / w));
+        return qtColorUtil::blend(sl->color, su->color, t, space);
+    }
+
+    auto const& a = *(sl == stops.begin() ? sl : sl - 1);
+    auto const& b = *sl;
+    auto const& c = *su;
+    auto const& d = *(su + 1 == stops.end() ? su : su + 1);
+
+    auto const& cb = b.color;
+    auto const& cc = c.color;
+    auto const& ca = qtColorUtil::blend(a.color, cb, 0.5, space);
+    auto const& cd = qtColorUtil::blend(d.color, cc, 0.5, space);
+    auto const& cm = qtColorUtil::blend(cb, cc, 0.5, space);
+    auto const pb = b.position, pc = c.position;
+    auto const pa = qtColorUtil::blend(a.position, pb, a.weight);
+    auto const pd = qtColorUtil::blend(d.position, pc, c.weight);
+    auto const pm = qtColorUtil::blend(pb, pc, w);
+
+    if (t > w)
+    {
+        t = (t - w) / (1.0 - w);
+        t = qtColorUtil::blend(pb, pm, pc, pd, t);
+        t = qBound(0.0, (t - pm) / (pc - pm), 1.0);
+        return qtColorUtil::blend(cb, cm, cc, cd, t, space);
+    }
+    else
+    {
+        t /= w;
+        t = qtColorUtil::blend(pa, pb, pm, pc, t);
+        t = qBound(0.0, (t - pb) / (pm - pb), 1.0);
+        return qtColorUtil::blend(ca, cb, cm, cc, t, space);
+    }
+}
+
+} // namespace <anonymous>
+
+//-----------------------------------------------------------------------------
+int testSegments(qtTest& t_obj)
+{
+    qtGradient::InterpolationMode const functions[] = {
+        qtGradient::InterpolateLinear,
+        qtGradient::InterpolateCubic,
+    };
+    qtGradient::InterpolationMode const spaces[] = {
+        qtGradient::InterpolateRgb,
+        qtGradient::InterpolateHsv,
+        qtGradient::InterpolateHsl,
+        qtGradient::InterpolateCmyk,
+    };
+
+    for (auto const function : functions)
+    {
+        for (auto const space : spaces)
+        {
+            qtGradient gradient{testStops(), function | space};
+
+            // Sample between and exactly at the stops
+            auto mismatches = 0;
+            for (int i = 0; i <= 1000; ++i)
+            {
+                auto const pos = static_cast<qreal>(i) / 1000.0;
+                auto const expected = referenceColorAt(gradient, pos);
+                auto const actual = gradient.at(pos);
+                if (!closeColor(actual.rgba(), expected.rgba(), 1))
+                {
+                    t_obj.out() << "  at(" << pos << ") = "
+                                << actual.name(QColor::HexArgb)
+                                << ", expected "
+                                << expected.name(QColor::HexArgb) << '\n';
+                    ++mismatches;
+                }
+            }
+            TEST_EQUAL(mismatches, 0);
+        }
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int testMap(qtTest& t_obj)
+{
+    QGradient::Spread const spreads[] = {
+        QGradient::PadSpread,
+        QGradient::RepeatSpread,
+        QGradient::ReflectSpread,
+    };
+    qtGradient::InterpolationMode const modes[] = {
+        qtGradient::InterpolateLinear | qtGradient::InterpolateRgb,
+        qtGradient::InterpolateCubic | qtGradient::InterpolateHsv,
+    };
+
+    auto const lo = 10.0f, hi = 30.0f;
+    auto const nanColor = QRgb{0x12345678};
+
+    // Use a count that is not a multiple of the vector width, so that both
+    // the vector and scalar parts of the kernels are exercised
+    auto const count = 1001;
+    QVector<float> values(count);
+    QVector<double> doubleValues(count);
+    QVector<qreal> positions(count);
+    for (int i = 0; i < count; ++i)
+    {
+        if (i % 7 == 3)
+        {
+            values[i] = std::numeric_limits<float>::quiet_NaN();
+            doubleValues[i] = std::numeric_limits<double>::quiet_NaN();
+            continue;
+        }
+
+        // Cover several periods on each side of the range, but avoid integer
+        // positions, where repeating gradients are discontinuous
+        auto t = -3.2 + (7.5 * i / count);
+        if (qAbs(t - std::round(t)) < 0.01)
+            t += 0.02;
+
+        values[i] = static_cast<float>(lo + (t * (hi - lo)));
+        doubleValues[i] = static_cast<double>(values[i]);
+        positions[i] = (static_cast<double>(values[i]) - lo) / (hi - lo);
+    }
+
+    for (auto const mode : modes)
+    {
+        for (auto const spread : spreads)
+        {
+            qtGradient gradient{testStops(), mode, spread};
+
+            QVector<QRgb> out(count), doubleOut(count);
+            gradient.map(values.constData(), count, lo, hi,
+                         out.data(), nanColor);
+            gradient.map(doubleValues.constData(), count, lo, hi,
+                         doubleOut.data(), nanColor);
+
+            auto mismatches = 0;
+            for (int i = 0; i < count; ++i)
+            {
+                if (std::isnan(values[i]))
+                {
+                    if (out[i] != nanColor || doubleOut[i] != nanColor)
+                        ++mismatches;
+                    continue;
+                }
+
+                // The table has 4096 entries, so allow for quantization
+                auto const pos = spreadPosition(positions[i], spread);
+                auto const expected = gradient.at(pos).rgba();
+                if (!closeColor(out[i], expected, 2) ||
+                    !closeColor(doubleOut[i], expected, 2))
+                {
+                    t_obj.out() << "  map(" << values[i] << ") = "
+                                << QString::number(out[i], 16)
+                                << ", expected "
+                                << QString::number(expected, 16) << '\n';
+                    ++mismatches;
+                }
+            }
+            TEST_EQUAL(mismatches, 0);
+
+            // Mapping a scalar field to an image gives the same colors
+            auto const image = gradient.renderImage(
+                values.constData(), QSize{count, 1}, lo, hi,
+                QImage::Format_ARGB32, nanColor);
+            auto imageMismatches = 0;
+            for (int i = 0; i < count; ++i)
+            {
+                if (image.pixel(i, 0) != out[i])
+                    ++imageMismatches;
+            }
+            TEST_EQUAL(imageMismatches, 0);
+        }
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int testRenderImage(qtTest& t_obj)
+{
+    qtGradient gradient{testStops(),
+                        qtGradient::InterpolateCubic |
+                        qtGradient::InterpolateHsl};
+
+    auto const width = 97, height = 61;
+    auto const row = gradient.render(width);
+    auto const column = gradient.render(height);
+
+    // Horizontal gradients run left to right, with every row the same; pixels
+    // are converted directly from the interpolated components, rather than
+    // through QColor, so allow for rounding
+    auto const horizontal = gradient.renderImage(QSize{width, height});
+    TEST_EQUAL(horizontal.size(), QSize(width, height));
+    TEST_EQUAL(horizontal.format(), QImage::Format_ARGB32);
+
+    auto mismatches = 0;
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            auto const expected = row[x].rgba();
+            if (!closeColor(horizontal.pixel(x, y), expected, 2))
+                ++mismatches;
+        }
+    }
+    TEST_EQUAL(mismatches, 0);
+
+    // Vertical gradients run bottom to top
+    auto const vertical =
+        gradient.renderImage(QSize{width, height}, Qt::Vertical);
+
+    mismatches = 0;
+    for (int y = 0; y < height; ++y)
+    {
+        auto const expected = column[height - 1 - y].rgba();
+        for (int x = 0; x < width; ++x)
+        {
+            if (!closeColor(vertical.pixel(x, y), expected, 2))
+                ++mismatches;
+        }
+    }
+    TEST_EQUAL(mismatches, 0);
+
+    // Opaque formats discard alpha
+    auto const opaque = gradient.renderImage(
+        QSize{width, 1}, Qt::Horizontal, QImage::Format_RGB32);
+    TEST_EQUAL(opaque.format(), QImage::Format_RGB32);
+
+    mismatches = 0;
+    for (int x = 0; x < width; ++x)
+    {
+        auto const expected = row[x].rgb();
+        if (!closeColor(opaque.pixel(x, 0), expected, 2))
+            ++mismatches;
+    }
+    TEST_EQUAL(mismatches, 0);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int testInvalidation(qtTest& t_obj)
+{
+    qtGradient gradient;
+    auto const before = gradient.lookupTable(16);
+    TEST_EQUAL(before.at(0.0), QColor{Qt::black}.rgba());
+    TEST_EQUAL(before.at(1.0), QColor{Qt::white}.rgba());
+
+    // A copy keeps the original stops (and tables) after the original changes
+    auto const copy = gradient;
+
+    gradient.setStops({{0.0, Qt::red}, {1.0, Qt::blue}});
+    auto const after = gradient.lookupTable(16);
+    TEST_EQUAL(after.at(0.0), QColor{Qt::red}.rgba());
+    TEST_EQUAL(after.at(1.0), QColor{Qt::blue}.rgba());
+    TEST_EQUAL(gradient.at(0.0), QColor{Qt::red});
+
+    float const value = 1.0f;
+    QRgb mapped;
+    gradient.map(&value, 1, 0.0f, 1.0f, &mapped);
+    TEST_EQUAL(mapped, QColor{Qt::blue}.rgba());
+
+    TEST_EQUAL(copy.lookupTable(16).at(0.0), QColor{Qt::black}.rgba());
+    copy.map(&value, 1, 0.0f, 1.0f, &mapped);
+    TEST_EQUAL(mapped, QColor{Qt::white}.rgba());
+
+    // Other changes to the stops and interpolation also invalidate the tables
+    gradient.insertStop(0.5, Qt::green);
+    TEST_EQUAL(gradient.lookupTable(3).at(0.5), QColor{Qt::green}.rgba());
+
+    gradient.removeStop(0.5);
+    TEST(gradient.lookupTable(3).at(0.5) != QColor{Qt::green}.rgba());
+
+    gradient.setInterpolationMode(qtGradient::InterpolateDiscrete);
+    TEST_EQUAL(gradient.lookupTable(16).at(0.4), QColor{Qt::red}.rgba());
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int testEmptyTable(qtTest& t_obj)
+{
+    qtGradient gradient;
+    gradient.setStops({{0.0, Qt::red}, {1.0, Qt::blue}});
+
+    // Tables have at least one entry, which is the start of the gradient
+    foreach (auto const size, QList<int>() << 0 << -1 << 1)
+    {
+        auto const lut = gradient.lookupTable(size);
+        TEST_EQUAL(lut.size(), 1);
+        TEST_EQUAL(lut.at(0.0), QColor{Qt::red}.rgba());
+        TEST_EQUAL(lut.at(1.0), QColor{Qt::red}.rgba());
+        TEST(lut.atF(0.5) == lut.colorsF());
+    }
+
+    // An empty table gives a defined value
+    qtGradient::LookupTable const empty;
+    TEST(empty.isEmpty());
+    TEST_EQUAL(empty.at(0.5), QRgb{0});
+    TEST(!empty.atF(0.5));
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int main()
+{
+#if defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+    // This executable uses AVX2; skip the test if the processor lacks it
+    if (!__builtin_cpu_supports("avx2"))
+    {
+        qWarning() << "AVX2 is not supported by this processor; skipping";
+        return 77;
+    }
+#endif
+
+    qtTest t_obj;
+
+    t_obj.runSuite("Segments", testSegments);
+    t_obj.runSuite("Map", testMap);
+    t_obj.runSuite("Render Image", testRenderImage);
+    t_obj.runSuite("Invalidation", testInvalidation);
+    t_obj.runSuite("Lookup Table Size", testEmptyTable);
+    return t_obj.result();
+}
@@ -0,0 +1,161 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#define TEST_OBJECT_NAME t_obj
+
+#include "../core/qtOnce.h"
+#include "../core/qtTest.h"
+#include "../core/qtThreadPool.h"
+
+#include <QAtomicInt>
+#include <QSemaphore>
+#include <QThread>
+#include <QVector>
+
+#include <stdexcept>
+
+namespace
+{
+
+qtOnceFlag onceFlag;
+QAtomicInt onceCount{0};
+
+struct Counted
+{
+  Counted() { ++instances; }
+  ~Counted() { --instances; }
+
+  static int instances;
+};
+
+int Counted::instances = 0;
+
+}
+
+//-----------------------------------------------------------------------------
+int testOnce(qtTest& t_obj)
+{
+  qtThreadPool pool{8};
+  for (int i = 0; i < 256; ++i)
+    {
+    pool.post([]{ qtOnce(onceFlag, []{ onceCount.ref(); }); });
+    }
+  pool.waitForDone();
+
+  TEST(onceFlag.isDone());
+  TEST_EQUAL(onceCount.load(), 1);
+
+  // A function that throws does not set the flag
+  qtOnceFlag flag;
+  auto caught = false;
+  try
+    {
+    qtOnce(flag, []{ throw std::runtime_error("expected"); });
+    }
+  catch (std::runtime_error const&)
+    {
+    caught = true;
+    }
+  TEST(caught);
+  TEST(!flag.isDone());
+
+  auto calls = 0;
+  qtOnce(flag, [&calls]{ ++calls; });
+  qtOnce(flag, [&calls]{ ++calls; });
+  TEST_EQUAL(calls, 1);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+template <typename Function>
+QVector<Counted*> getConcurrently(Function function)
+{
+  // Release all tasks at once from a barrier, so that they race to create
+  // the object; the pool must have a thread for every task
+  auto const count = 8;
+  qtThreadPool pool{count};
+  QSemaphore arrived, start;
+  QVector<Counted*> results(count, nullptr);
+  auto* const data = results.data();
+
+  for (int i = 0; i < count; ++i)
+    {
+    pool.post([&, data, i]{
+      arrived.release();
+      start.acquire();
+      data[i] = function();
+    });
+    }
+
+  arrived.acquire(count);
+  start.release(count);
+  pool.waitForDone();
+
+  return results;
+}
+
+//-----------------------------------------------------------------------------
+int testLazy(qtTest& t_obj)
+{
+  {
+    qtLazy<Counted> lazy;
+    TEST(!lazy.exists());
+
+    auto const results = getConcurrently([&lazy]{ return lazy.get(); });
+
+    TEST(lazy.exists());
+    TEST(results.first());
+    TEST_EQUAL(results.count(results.first()), results.count());
+    TEST_EQUAL(lazy.get(), results.first());
+    TEST_EQUAL(Counted::instances, 1);
+  }
+
+  // Owned instance is destroyed with the holder
+  TEST_EQUAL(Counted::instances, 0);
+
+  // Factory returning null is retried on the next access
+  Counted external;
+  qtLazy<Counted> lazy;
+  TEST(!lazy.get([]() -> Counted* { return 0; }));
+  TEST(!lazy.exists());
+  TEST_EQUAL(lazy.get([&external]{ return &external; }), &external);
+  TEST_EQUAL(lazy.get([]() -> Counted* { return 0; }), &external);
+
+  // A slow factory is called only once, even when the first accesses are
+  // concurrent, and all callers receive the object it created
+  {
+    qtLazy<Counted> slowLazy;
+    QAtomicInt factoryCalls{0};
+    auto const factory = [&factoryCalls]{
+      factoryCalls.ref();
+      QThread::msleep(50);
+      return new Counted;
+    };
+
+    auto const results = getConcurrently(
+      [&slowLazy, &factory]{ return slowLazy.get(factory); });
+
+    TEST_EQUAL(factoryCalls.load(), 1);
+    TEST(results.first());
+    TEST_EQUAL(results.count(results.first()), results.count());
+    TEST_EQUAL(Counted::instances, 2);
+
+    // The factory's object is not owned by the holder
+    delete results.first();
+  }
+  TEST_EQUAL(Counted::instances, 1);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int main()
+{
+  qtTest t_obj;
+
+  t_obj.runSuite("Once", testOnce);
+  t_obj.runSuite("Lazy", testLazy);
+  return t_obj.result();
+}
@@ -0,0 +1,143 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#define TEST_OBJECT_NAME t_obj
+
+#include "../core/qtTest.h"
+#include "../core/qtThreadPool.h"
+#include "../util/qtStatusManager.h"
+#include "../util/qtStatusSource.h"
+
+#include <QApplication>
+#include <QLabel>
+#include <QProgressBar>
+#include <QScopedPointer>
+
+//-----------------------------------------------------------------------------
+int testSenders(qtTest& t_obj)
+{
+  qtStatusManager manager;
+  QLabel label;
+  manager.addStatusLabel(&label);
+
+  QObject a, b;
+  QScopedPointer<QObject> c{new QObject};
+
+  manager.setStatusText(&a, "a");
+  manager.setStatusText(&b, "b");
+  manager.setStatusText(c.data(), "c");
+  TEST_EQUAL(label.text(), QString("c"));
+
+  // Updating a sender moves it to the top
+  manager.setStatusText(&a, "a2");
+  TEST_EQUAL(label.text(), QString("a2"));
+
+  // Clearing the top sender shows the next most recent
+  manager.setStatusText(&a);
+  TEST_EQUAL(label.text(), QString("c"));
+
+  // Destroying the top sender's owner also removes it
+  c.reset();
+  TEST_EQUAL(label.text(), QString("b"));
+
+  // Clearing a sender that is not on top does not change the display
+  manager.setStatusText(&a, "a3");
+  manager.setStatusText(&b);
+  TEST_EQUAL(label.text(), QString("a3"));
+
+  manager.setStatusText(&a);
+  TEST(label.text().isEmpty());
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int testProgressTree(qtTest& t_obj)
+{
+  QObject rootOwner, aOwner, bOwner, cOwner;
+
+  qtStatusSource root{&rootOwner};
+  auto a = root.createChild(&aOwner, 1);
+  auto b = root.createChild(&bOwner, 3);
+  a.setProgressTotal(1000);
+  b.setProgressTotal(1000);
+
+  // Update children concurrently
+  {
+    qtThreadPool pool{8};
+    for (int i = 0; i < 1000; ++i)
+      {
+      pool.post([a]{ qtStatusSource s = a; s.addProgressCompleted(); });
+      }
+    for (int i = 0; i < 500; ++i)
+      {
+      pool.post([b]{ qtStatusSource s = b; s.addProgressCompleted(); });
+      }
+    pool.waitForDone();
+  }
+
+  TEST_EQUAL(a.progress(), 1.0);
+  TEST_EQUAL(b.progress(), 0.5);
+  TEST_EQUAL(root.progress(), ((1.0 * 1.0) + (0.5 * 3.0)) / 4.0);
+
+  // A released child keeps contributing its final progress
+  {
+    auto c = root.createChild(&cOwner, 4);
+    c.setProgressTotal(10);
+    c.setProgressCompleted(5);
+    TEST_EQUAL(root.progress(), (1.0 + 1.5 + 2.0) / 8.0);
+  }
+  TEST_EQUAL(root.progress(), (1.0 + 1.5 + 2.0) / 8.0);
+
+  // The manager displays the aggregate progress of the root
+  qtStatusManager manager;
+  QProgressBar bar;
+  manager.addProgressBar(&bar);
+  manager.setAggregateProgress(root);
+  TEST_EQUAL(bar.maximum(), 10000);
+  TEST_EQUAL(bar.value(), 5625);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int testReleasedChildren(qtTest& t_obj)
+{
+  QObject rootOwner, aOwner, bOwner;
+
+  qtStatusSource root{&rootOwner};
+  QScopedPointer<qtStatusSource> a{
+    new qtStatusSource{root.createChild(&aOwner)}};
+  auto b = root.createChild(&bOwner);
+  a->setProgressTotal(2);
+  b.setProgressTotal(2);
+
+  a->setProgressCompleted(2);
+  TEST_EQUAL(root.progress(), 0.5);
+
+  // Releasing a completed child does not move the parent's progress
+  // backwards
+  a.reset();
+  TEST_EQUAL(root.progress(), 0.5);
+
+  b.setProgressCompleted(1);
+  TEST_EQUAL(root.progress(), 0.75);
+
+  b.setProgressCompleted(2);
+  TEST_EQUAL(root.progress(), 1.0);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  QApplication app(argc, argv); // Needed to construct widgets
+  qtTest t_obj;
+
+  t_obj.runSuite("Senders", testSenders);
+  t_obj.runSuite("Progress Tree", testProgressTree);
+  t_obj.runSuite("Released Children", testReleasedChildren);
+  return t_obj.result();
+}
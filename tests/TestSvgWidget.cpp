@@ -13,11 +13,9 @@ int main(int argc, char** argv)
 
     qtSvgWidget w;
 
-    if (argc > 1)
-    {
-        w.setResource(argv[1]);
-        w.resize(w.sizeHint());
-    }
+    // Default to the test icons, which are pre-rendered at build time
+    w.setResource(argc > 1 ? QString{argv[1]} : ":/tests/icons.svg");
+    w.resize(w.sizeHint());
 
     w.show();
     return app.exec();
@@ -0,0 +1,133 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#define TEST_OBJECT_NAME t_obj
+
+#include "../core/qtTest.h"
+#include "../core/qtThreadPool.h"
+#include "../util/qtProcess.h"
+#include "../util/qtTask.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+
+#include <stdexcept>
+
+//-----------------------------------------------------------------------------
+qtTask<int> square(int value)
+{
+    co_await qtAwaitTimeout(0);
+    co_return value * value;
+}
+
+//-----------------------------------------------------------------------------
+qtTask<> testPool(qtTest& t_obj, bool& finished)
+{
+    qtThreadPool pool{2};
+    auto* const thread = QThread::currentThread();
+
+    QThread* workerThread = nullptr;
+    auto const result = co_await qtAwaitPool(
+        [&workerThread]{
+            workerThread = QThread::currentThread();
+            return 42;
+        }, &pool);
+
+    TEST_EQUAL(result, 42);
+    TEST(workerThread != thread);
+    TEST(QThread::currentThread() == thread);
+
+    // Exceptions thrown by the function are rethrown in the coroutine
+    auto caught = false;
+    try
+    {
+        co_await qtAwaitPool([]{ throw std::runtime_error{"expected"}; },
+                             &pool);
+    }
+    catch (std::runtime_error const&)
+    {
+        caught = true;
+    }
+    TEST(caught);
+    TEST(QThread::currentThread() == thread);
+
+    // Tasks may be awaited by other tasks
+    TEST_EQUAL(co_await square(7), 49);
+
+    finished = true;
+}
+
+//-----------------------------------------------------------------------------
+qtTask<> testSignal(qtTest& t_obj, bool& finished)
+{
+    // QBuffer only emits bytesWritten if the signal is connected when data is
+    // written, so write once the coroutine has suspended
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QTimer::singleShot(0, &buffer, [&buffer]{ buffer.write("hello", 5); });
+
+    auto const written =
+        co_await qtAwaitSignal(&buffer, &QIODevice::bytesWritten);
+    TEST_EQUAL(written, qint64{5});
+    TEST_EQUAL(buffer.data(), QByteArray{"hello"});
+
+    finished = true;
+}
+
+//-----------------------------------------------------------------------------
+qtTask<> testProcess(qtTest& t_obj, bool& finished)
+{
+    // Run this executable as the child process, asking it to exit immediately
+    // with a known exit code
+    qtProcess process;
+    process.start(QCoreApplication::applicationFilePath(),
+                  QStringList{"--exit", "3"});
+    TEST(process.waitForStarted());
+
+    TEST_EQUAL(co_await qtAwaitProcess(&process), 3);
+
+    // A process that is not running does not suspend the coroutine
+    TEST_EQUAL(co_await qtAwaitProcess(&process), 3);
+
+    finished = true;
+}
+
+//-----------------------------------------------------------------------------
+template <qtTask<> (*Coroutine)(qtTest&, bool&)>
+int runCoroutine(qtTest& t_obj)
+{
+    auto finished = false;
+    auto const task = Coroutine(t_obj, finished);
+
+    QElapsedTimer timer;
+    timer.start();
+    while (!task.isFinished() && timer.elapsed() < 30000)
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 100);
+
+    TEST(task.isFinished());
+    TEST(finished);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    auto const args = app.arguments();
+    if (args.count() == 3 && args[1] == "--exit")
+        return args[2].toInt();
+
+    qtTest t_obj;
+
+    t_obj.runSuite("Pool", runCoroutine<testPool>);
+    t_obj.runSuite("Signal", runCoroutine<testSignal>);
+    t_obj.runSuite("Process", runCoroutine<testProcess>);
+    return t_obj.result();
+}
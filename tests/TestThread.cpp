@@ -0,0 +1,105 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#define TEST_OBJECT_NAME t_obj
+
+#include "../core/qtTest.h"
+#include "../core/qtThread.h"
+
+#include <QElapsedTimer>
+#include <QSemaphore>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#endif
+
+namespace // anonymous
+{
+
+//-----------------------------------------------------------------------------
+class TestThread : public qtThread
+{
+public:
+    QByteArray nativeName;
+    QThread::Priority priority = QThread::InheritPriority;
+    qint64 cpuTime = -1;
+
+    QSemaphore ready;
+    QSemaphore finish;
+
+protected:
+    void run() override
+    {
+#ifdef Q_OS_LINUX
+        char name[16] = {};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        this->nativeName = name;
+#endif
+        this->priority = QThread::currentThread()->priority();
+
+        // Consume some processor time
+        QElapsedTimer timer;
+        timer.start();
+        auto volatile sink = 0u;
+        while (timer.elapsed() < 100)
+        {
+            for (auto i = 0u; i < 10000; ++i)
+                sink = sink + i;
+        }
+        this->cpuTime = qtBareThread::currentThreadCpuTime();
+
+        this->ready.release();
+        this->finish.acquire();
+    }
+};
+
+} // namespace <anonymous>
+
+//-----------------------------------------------------------------------------
+int testSettings(qtTest& t_obj)
+{
+    TestThread thread;
+
+    // "worker" followed by five two-byte characters is 16 bytes of UTF-8; the
+    // name must be truncated before the last character, not within it
+    auto const name = QString::fromUtf8("worker\xc3\xa9\xc3\xa9\xc3\xa9"
+                                        "\xc3\xa9\xc3\xa9");
+    thread.setThreadName(name);
+    thread.setThreadPriority(QThread::LowPriority);
+    TEST_EQUAL(thread.threadName(), name);
+    TEST_EQUAL(thread.threadPriority(), QThread::LowPriority);
+    TEST_EQUAL(thread.threadCpuTime(), qint64{-1});
+
+    thread.start();
+    TEST(thread.ready.tryAcquire(1, 10000));
+
+    TEST_EQUAL(thread.priority, QThread::LowPriority);
+#ifdef Q_OS_LINUX
+    TEST_EQUAL(thread.nativeName,
+               QByteArray{"worker\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9"});
+#endif
+
+    // Processor time is reported, by the thread itself and by other threads,
+    // where the platform supports it
+    if (qtBareThread::currentThreadCpuTime() >= 0)
+    {
+        TEST(thread.cpuTime > 0);
+        TEST(thread.threadCpuTime() >= thread.cpuTime);
+    }
+
+    thread.finish.release();
+    TEST(thread.wait(10000));
+    TEST_EQUAL(thread.threadCpuTime(), qint64{-1});
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int main()
+{
+  qtTest t_obj;
+
+  t_obj.runSuite("Thread Settings", testSettings);
+  return t_obj.result();
+}
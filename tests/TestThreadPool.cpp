@@ -0,0 +1,154 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#define TEST_OBJECT_NAME t_obj
+
+#include "../core/qtParallel.h"
+#include "../core/qtTest.h"
+#include "../core/qtThreadPool.h"
+
+#include <QAtomicInt>
+#include <QVector>
+
+#include <stdexcept>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+int testSubmit(qtTest& t_obj)
+{
+    qtThreadPool pool{4};
+    TEST_EQUAL(pool.threadCount(), 4);
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 1000; ++i)
+        results.push_back(pool.submit([i]{ return i * i; }));
+
+    auto sum = 0ll;
+    for (auto& r : results)
+        sum += r.get();
+    TEST_EQUAL(sum, 332833500ll);
+
+    auto error = pool.submit([]() -> int {
+        throw std::runtime_error{"expected"};
+    });
+    auto caught = false;
+    try
+    {
+        error.get();
+    }
+    catch (std::runtime_error const&)
+    {
+        caught = true;
+    }
+    TEST(caught);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int testNested(qtTest& t_obj)
+{
+    qtThreadPool pool{3};
+    QAtomicInt count{0};
+
+    // Tasks that spawn more tasks are queued on the spawning worker, and must
+    // be stolen by the other workers
+    for (int i = 0; i < 16; ++i)
+    {
+        pool.post([&pool, &count]{
+            for (int j = 0; j < 64; ++j)
+                pool.post([&count]{ count.ref(); },
+                          qtThreadPool::HighPriority);
+        });
+    }
+
+    pool.waitForDone();
+    TEST_EQUAL(count.load(), 16 * 64);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int testQueue(qtTest& t_obj)
+{
+    qtThreadPool pool{4};
+    QVector<int> order;
+
+    {
+        qtThreadPoolQueue queue{&pool};
+        for (int i = 0; i < 500; ++i)
+        {
+            queue.post([i, &order, &queue]{
+                if (queue.isCurrent())
+                    order.append(i);
+            });
+        }
+    } // Queue waits for completion on destruction
+
+    TEST_EQUAL(order.count(), 500);
+    auto ordered = true;
+    for (int i = 0; i < order.count(); ++i)
+        ordered = ordered && (order[i] == i);
+    TEST(ordered);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int testParallel(qtTest& t_obj)
+{
+    qtThreadPool pool{4};
+
+    QVector<int> values(10000);
+    qtParallel::transform(qtIndexRange(values.count()), values.begin(),
+                          [](int i){ return i % 7; }, 0, &pool);
+
+    auto expected = 0ll;
+    for (auto const v : values)
+        expected += v;
+
+    auto const sum = qtParallel::reduce(
+        qtIndexRange(values.count()), 0ll,
+        [&values](int i){ return static_cast<long long>(values[i]); },
+        [](long long a, long long b){ return a + b; }, 0, &pool);
+    TEST_EQUAL(sum, expected);
+
+    // Reduce to bool with small chunks, so that many neighbouring partial
+    // results are written concurrently
+    auto const allSmall = qtParallel::reduce(
+        qtIndexRange(values.count()), true,
+        [&values](int i){ return values[i] < 7; },
+        [](bool a, bool b){ return a && b; }, 1, &pool);
+    TEST(allSmall);
+
+    auto const anyBig = qtParallel::reduce(
+        qtIndexRange(values.count()), false,
+        [&values](int i){ return values[i] > 5; },
+        [](bool a, bool b){ return a || b; }, 1, &pool);
+    TEST(anyBig);
+
+    QAtomicInt count{0};
+    qtParallel::forEach(qtIndexRange(100, 1100),
+                        [&count](int){ count.ref(); }, 16, &pool);
+    TEST_EQUAL(count.load(), 1000);
+
+    auto const r = qtIndexRange(10, 20);
+    TEST_EQUAL(static_cast<int>(r.end() - r.begin()), 10);
+    TEST_EQUAL(*(r.begin() + 3), 13);
+    TEST_EQUAL(r.begin()[9], 19);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+int main()
+{
+  qtTest t_obj;
+
+  t_obj.runSuite("Submit", testSubmit);
+  t_obj.runSuite("Nested Tasks", testNested);
+  t_obj.runSuite("Serial Queue", testQueue);
+  t_obj.runSuite("Parallel Loops", testParallel);
+  return t_obj.result();
+}
@@ -0,0 +1,158 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#define TEST_OBJECT_NAME t_obj
+
+#include <QApplication>
+#include <QLineEdit>
+#include <QScrollBar>
+#include <QStandardItemModel>
+
+#include "../core/qtTest.h"
+
+#include "../widgets/qtVirtualDrawerWidget.h"
+
+namespace // anonymous
+{
+
+//-----------------------------------------------------------------------------
+class EditableDrawers : public qtVirtualDrawerWidget
+{
+protected:
+  virtual QWidget* createWidget(int column, QWidget* parent) QTE_OVERRIDE
+    {
+    if (column == 1)
+      {
+      return new QLineEdit(parent);
+      }
+    return qtVirtualDrawerWidget::createWidget(column, parent);
+    }
+};
+
+//-----------------------------------------------------------------------------
+void buildModel(QStandardItemModel& model, int rows)
+{
+  model.setColumnCount(2);
+  for (int i = 0; i < rows; ++i)
+    {
+    QList<QStandardItem*> row;
+    row << new QStandardItem(QString("drawer %1").arg(i))
+        << new QStandardItem(QString::number(i));
+    for (int j = 0; j < 5; ++j)
+      {
+      QList<QStandardItem*> childRow;
+      childRow << new QStandardItem(QString("child %1.%2").arg(i).arg(j))
+               << new QStandardItem(QString::number(j));
+      row.first()->appendRow(childRow);
+      }
+    model.appendRow(row);
+    }
+}
+
+//-----------------------------------------------------------------------------
+int rowWidgetCount(qtVirtualDrawerWidget& drawers)
+{
+  return drawers.viewport()->findChildren<QWidget*>(
+    QString(), Qt::FindDirectChildrenOnly).count();
+}
+
+} // namespace <anonymous>
+
+//-----------------------------------------------------------------------------
+int testVirtualization(qtTest& t_obj)
+{
+  QStandardItemModel model;
+  buildModel(model, 10000);
+
+  qtVirtualDrawerWidget drawers;
+  drawers.setRowHeight(20);
+  drawers.setModel(&model);
+  drawers.resize(400, 200);
+  drawers.show();
+  QCoreApplication::processEvents();
+
+  TEST_EQUAL(drawers.visibleRowCount(), 10000);
+
+  // Only the rows in the viewport have widgets (plus, at most, one spare)
+  auto const maxWidgets = (drawers.viewport()->height() / 20) + 2;
+  TEST(rowWidgetCount(drawers) <= maxWidgets);
+  TEST(drawers.indexWidget(model.index(0, 0)));
+  TEST(!drawers.indexWidget(model.index(5000, 0)));
+
+  // Scrolling recycles widgets rather than creating more
+  auto* const sb = drawers.verticalScrollBar();
+  sb->setValue(sb->maximum());
+  QCoreApplication::processEvents();
+  TEST(rowWidgetCount(drawers) <= maxWidgets);
+  TEST(!drawers.indexWidget(model.index(0, 0)));
+  TEST(drawers.indexWidget(model.index(9999, 0)));
+
+  // Expanding a drawer adds rows, but no widgets beyond those needed
+  drawers.setExpanded(model.index(9999, 0), true);
+  drawers.scrollTo(model.index(4, 0, model.index(9999, 0)));
+  QCoreApplication::processEvents();
+  TEST_EQUAL(drawers.visibleRowCount(), 10005);
+  TEST(rowWidgetCount(drawers) <= maxWidgets);
+  TEST(drawers.indexWidget(model.index(4, 0, model.index(9999, 0))));
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int testEditing(qtTest& t_obj)
+{
+  QStandardItemModel model;
+  buildModel(model, 1000);
+
+  EditableDrawers drawers;
+  drawers.setRowHeight(20);
+  drawers.setModel(&model);
+  drawers.resize(400, 200);
+  drawers.show();
+  QCoreApplication::processEvents();
+
+  // Edits are written to the model as they are made
+  auto* const editor =
+    qobject_cast<QLineEdit*>(drawers.indexWidget(model.index(1, 1)));
+  if (TEST(editor))
+    {
+    return 1;
+    }
+  TEST_EQUAL(editor->text(), QString("1"));
+  editor->setText("edited");
+  TEST_EQUAL(model.index(1, 1).data().toString(), QString("edited"));
+
+  // ...and survive the widget being recycled for another row
+  drawers.scrollTo(model.index(999, 0));
+  QCoreApplication::processEvents();
+  TEST(!drawers.indexWidget(model.index(1, 1)));
+  TEST_EQUAL(model.index(1, 1).data().toString(), QString("edited"));
+
+  drawers.scrollTo(model.index(0, 0));
+  QCoreApplication::processEvents();
+  auto* const rebound =
+    qobject_cast<QLineEdit*>(drawers.indexWidget(model.index(1, 1)));
+  if (TEST(rebound))
+    {
+    return 1;
+    }
+  TEST_EQUAL(rebound->text(), QString("edited"));
+
+  // Changes to the model are shown by the widgets
+  model.setData(model.index(1, 1), QString("changed"));
+  TEST_EQUAL(rebound->text(), QString("changed"));
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  QApplication app(argc, argv); // Needed to construct widgets
+  qtTest t_obj;
+
+  t_obj.runSuite("Virtualization", testVirtualization);
+  t_obj.runSuite("Editing", testEditing);
+  return t_obj.result();
+}
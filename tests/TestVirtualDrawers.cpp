@@ -0,0 +1,40 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#include <QApplication>
+#include <QStandardItemModel>
+
+#include "../widgets/qtVirtualDrawerWidget.h"
+
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  QApplication app(argc, argv);
+
+  // Build a model with many drawers, each having a few children; only the
+  // drawers in the viewport will have widgets
+  QStandardItemModel model;
+  model.setColumnCount(2);
+  for (int i = 0; i < 10000; ++i)
+    {
+    QList<QStandardItem*> row;
+    row << new QStandardItem(QString("drawer %1").arg(i))
+        << new QStandardItem(QString::number(i));
+    for (int j = 0; j < 5; ++j)
+      {
+      QList<QStandardItem*> childRow;
+      childRow << new QStandardItem(QString("child %1.%2").arg(i).arg(j))
+               << new QStandardItem(QString::number(j));
+      row.first()->appendRow(childRow);
+      }
+    model.appendRow(row);
+    }
+
+  qtVirtualDrawerWidget drawers;
+  drawers.setModel(&model);
+  drawers.resize(400, 600);
+
+  drawers.show();
+  return app.exec();
+}
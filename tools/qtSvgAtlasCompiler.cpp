@@ -0,0 +1,263 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#include "qteVersion.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QString>
+#include <QStringList>
+#include <QSvgRenderer>
+#include <QTextStream>
+
+//-----------------------------------------------------------------------------
+QDebug err(QString file = QString())
+{
+  QString prefix = "qte-sac:";
+  if (!file.isEmpty())
+    {
+    prefix += ' ' + file + ':';
+    }
+  return QDebug{QtCriticalMsg} << qPrintable(prefix) << "error:";
+}
+
+//-----------------------------------------------------------------------------
+void usage()
+{
+  QDebug{QtDebugMsg}
+    << "usage: qte-sac <output qrc> <resource prefix> <sizes> <ratios>"
+       " <svg file> [ <svg file> ... ]\n"
+       "  <sizes> and <ratios> are comma-separated lists, e.g. '16,24,32'"
+       " and '1,2'";
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+bool parseList(QString const& text, QList<T>& out, T (*convert)(QString))
+{
+  foreach (auto const& part, text.split(',', QString::SkipEmptyParts))
+    {
+    auto const value = convert(part.trimmed());
+    if (!(value > T{0}))
+      {
+      err() << "invalid list value" << part;
+      return false;
+      }
+    out.append(value);
+    }
+  return !out.isEmpty();
+}
+
+//-----------------------------------------------------------------------------
+int toInt(QString s) { return s.toInt(); }
+double toDouble(QString s) { return s.toDouble(); }
+
+//-----------------------------------------------------------------------------
+// Compute the size at which qtSvgWidget renders an image with the specified
+// default size into a square box; this must match
+// qtSvgWidgetPrivate::adjustedSize, so that the pre-rendered images are found
+QSize fitSize(QSize const& baseSize, int box)
+{
+  auto const ba = static_cast<double>(baseSize.width()) /
+                  static_cast<double>(baseSize.height());
+
+  if (ba > 1.0)
+    {
+    return {box, static_cast<int>(static_cast<double>(box) / ba)};
+    }
+  return {static_cast<int>(static_cast<double>(box) * ba), box};
+}
+
+//-----------------------------------------------------------------------------
+bool processSvg(QString const& svgName, QString const& prefix,
+                QList<int> const& sizes, QList<double> const& ratios,
+                QDir const& outDir, QString const& atlasName,
+                QJsonObject& index, QTextStream& qrc)
+{
+  QSvgRenderer renderer;
+  if (!renderer.load(svgName) || !renderer.isValid())
+    {
+    err(svgName) << "unable to load SVG";
+    return false;
+    }
+
+  auto const fileName = QFileInfo{svgName}.fileName();
+  auto const baseName = QFileInfo{svgName}.completeBaseName();
+  auto const resource = QString{":%1/%2"}.arg(prefix, fileName);
+
+  // Embed the SVG itself, so that live rendering is available for sizes that
+  // were not pre-rendered
+  qrc << "  <qresource prefix=\"" << prefix << "\">\n"
+      << "    <file alias=\"" << fileName << "\">"
+      << QFileInfo{svgName}.absoluteFilePath() << "</file>\n"
+      << "  </qresource>\n";
+
+  // Build list of logical sizes; include the default size, which is used by
+  // widgets that do not scale their contents
+  auto const defaultSize = renderer.defaultSize();
+  QList<QSize> logicalSizes{defaultSize};
+  foreach (auto const box, sizes)
+    {
+    auto const size = fitSize(defaultSize, box);
+    if (!size.isEmpty() && !logicalSizes.contains(size))
+      {
+      logicalSizes.append(size);
+      }
+    }
+
+  QJsonArray entries;
+  qrc << "  <qresource prefix=\"/qtSvgAtlas/" << atlasName << "\">\n";
+  foreach (auto const& size, logicalSizes)
+    {
+    foreach (auto const dpr, ratios)
+      {
+      auto const physicalSize = (QSizeF{size} * dpr).toSize();
+
+      QImage image{physicalSize, QImage::Format_ARGB32_Premultiplied};
+      image.setDevicePixelRatio(dpr);
+      image.fill(Qt::transparent);
+
+      QPainter painter{&image};
+      painter.setRenderHint(QPainter::Antialiasing);
+      renderer.render(&painter, QRect{{0, 0}, size});
+      painter.end();
+
+      auto const imageName = QString{"%1-%2x%3@%4.png"}
+        .arg(baseName).arg(size.width()).arg(size.height()).arg(dpr);
+      auto const imagePath = outDir.absoluteFilePath(imageName);
+      if (!image.save(imagePath, "PNG"))
+        {
+        err(imagePath) << "unable to write image";
+        return false;
+        }
+
+      qrc << "    <file alias=\"" << imageName << "\">"
+          << imagePath << "</file>\n";
+
+      QJsonObject entry;
+      entry.insert("width", size.width());
+      entry.insert("height", size.height());
+      entry.insert("ratio", dpr);
+      entry.insert("image", imageName);
+      entries.append(entry);
+      }
+    }
+  qrc << "  </qresource>\n";
+
+  // Record the default size, so that widgets can compute their size hints
+  // without parsing the SVG
+  QJsonObject document;
+  document.insert("width", defaultSize.width());
+  document.insert("height", defaultSize.height());
+  document.insert("images", entries);
+  index.insert(resource, document);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  // Rendering does not require a display
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+  QGuiApplication app(argc, argv);
+  QStringList args = app.arguments().mid(1);
+
+  if (args.count() < 5)
+    {
+    err() << "not enough arguments";
+    usage();
+    return 2;
+    }
+
+  auto const qrcName = args.takeFirst();
+  auto prefix = args.takeFirst();
+  while (prefix.endsWith('/'))
+    {
+    prefix.chop(1);
+    }
+  if (!prefix.startsWith('/'))
+    {
+    prefix.prepend('/');
+    }
+
+  QList<int> sizes;
+  QList<double> ratios;
+  if (!parseList(args.takeFirst(), sizes, &toInt) ||
+      !parseList(args.takeFirst(), ratios, &toDouble))
+    {
+    usage();
+    return 2;
+    }
+
+  // Images are written to a directory alongside the resource file
+  auto const atlasName = QFileInfo{qrcName}.completeBaseName();
+  auto outDir = QFileInfo{qrcName}.absoluteDir();
+  if (!outDir.mkpath(atlasName) || !outDir.cd(atlasName))
+    {
+    err(outDir.absoluteFilePath(atlasName)) << "unable to create directory";
+    return 1;
+    }
+
+  QString qrcText;
+  QTextStream qrc{&qrcText};
+  qrc << "<!-- Generated by QtExtensions SVG Atlas Compiler version "
+      << QTE_VERSION_STR << " -->\n"
+      << "<RCC>\n";
+
+  int retval = 0;
+  QJsonObject index;
+  foreach (auto const& svgName, args)
+    {
+    if (!processSvg(svgName, prefix, sizes, ratios, outDir, atlasName,
+                    index, qrc))
+      {
+      retval = 1;
+      }
+    }
+
+  // Write index
+  auto const indexPath = outDir.absoluteFilePath("index.json");
+  QFile indexFile{indexPath};
+  if (!indexFile.open(QIODevice::WriteOnly))
+    {
+    err(indexPath) << "unable to open file";
+    return 1;
+    }
+  indexFile.write(QJsonDocument{index}.toJson(QJsonDocument::Compact));
+  indexFile.close();
+
+  qrc << "  <qresource prefix=\"/qtSvgAtlas/" << atlasName << "\">\n"
+      << "    <file alias=\"index.json\">" << indexPath << "</file>\n"
+      << "  </qresource>\n"
+      << "</RCC>\n";
+  qrc.flush();
+
+  // Write resource file
+  QFile qrcFile{qrcName};
+  if (!qrcFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+    err(qrcName) << "unable to open file";
+    return 1;
+    }
+  qrcFile.write(qrcText.toUtf8());
+
+  if (retval)
+    {
+    err() << "error(s) occurred";
+    }
+
+  return retval;
+}
@@ -8,6 +8,7 @@
 #include <QHash>
 
 #include "../core/qtEnumerate.h"
+#include "../core/qtOnce.h"
 #include "../core/qtUtil.h"
 
 #include "qtActionFactory.h"
@@ -17,6 +18,8 @@ QTE_IMPLEMENT_D_FUNC(qtActionManager)
 namespace
 {
 typedef QHash<QAction*, QString> StaticActionMap;
+
+qtLazy<qtActionManager> theInstance;
 }
 
 //-----------------------------------------------------------------------------
@@ -30,24 +33,21 @@ public:
 //-----------------------------------------------------------------------------
 qtActionManager* qtActionManager::instance()
 {
-  static qtActionManager* theInstance = 0;
-
   // Create global instance, if it doesn't exist. The global QCoreApplication
   // instance must be created first, as we parent ourselves to it so that it
   // will garbage collect us on shutdown.
-  if (!theInstance)
-    {
+  return theInstance.get([]() -> qtActionManager* {
     QCoreApplication* app = QCoreApplication::instance();
-    if (app)
+    if (!app)
       {
-      // Take this opportunity to register QKeySequence as a metatype
-      qRegisterMetaType<QKeySequence>("QKeySequence");
-      qRegisterMetaTypeStreamOperators<QKeySequence>("QKeySequence");
-      theInstance = new qtActionManager(app);
+      return 0;
       }
-    }
 
-  return theInstance;
+    // Take this opportunity to register QKeySequence as a metatype
+    qRegisterMetaType<QKeySequence>("QKeySequence");
+    qRegisterMetaTypeStreamOperators<QKeySequence>("QKeySequence");
+    return new qtActionManager(app);
+  });
 }
 
 //-----------------------------------------------------------------------------
@@ -0,0 +1,234 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#include "qtAnimationDriver.h"
+
+#include <QAnimationDriver>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+#include <QWidget>
+
+#include <qmath.h>
+
+QTE_IMPLEMENT_D_FUNC(qtAnimationDriver)
+
+namespace // anonymous
+{
+thread_local qtAnimationDriver* currentDriver = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+class qtAnimationDriverPrivate : public QAnimationDriver
+{
+public:
+  qtAnimationDriverPrivate(qtAnimationDriver* q);
+
+  void tick();
+  void flushUpdates();
+
+  int interval() const { return qMax(1, qRound(1e3 / this->frameRate)); }
+
+  QTimer timer;
+  double frameRate;
+
+  // Updates requested during the current frame
+  bool advancing;
+  QSet<QWidget*> pendingSet;
+  QList<QPointer<QWidget>> pendingUpdates;
+
+  // Statistics
+  QElapsedTimer clock;
+  qint64 lastFrameStart;
+  qint64 totalInterval;
+  qint64 totalFrameTime;
+  qtAnimationDriver::FrameStatistics statistics;
+
+protected:
+  virtual void start() override;
+  virtual void stop() override;
+
+private:
+  QTE_DECLARE_PUBLIC(qtAnimationDriver)
+  QTE_DECLARE_PUBLIC_PTR(qtAnimationDriver)
+};
+
+//-----------------------------------------------------------------------------
+qtAnimationDriverPrivate::qtAnimationDriverPrivate(qtAnimationDriver* q)
+  : frameRate(60.0), advancing(false), lastFrameStart(-1),
+    totalInterval(0), totalFrameTime(0), q_ptr(q)
+{
+  this->timer.setTimerType(Qt::PreciseTimer);
+  connect(&this->timer, &QTimer::timeout, this, [this]{ this->tick(); });
+  this->clock.start();
+}
+
+//-----------------------------------------------------------------------------
+void qtAnimationDriverPrivate::start()
+{
+  this->lastFrameStart = -1;
+  this->timer.start(this->interval());
+  QAnimationDriver::start();
+}
+
+//-----------------------------------------------------------------------------
+void qtAnimationDriverPrivate::stop()
+{
+  this->timer.stop();
+  QAnimationDriver::stop();
+}
+
+//-----------------------------------------------------------------------------
+void qtAnimationDriverPrivate::tick()
+{
+  QTE_Q();
+
+  auto const frameStart = this->clock.nsecsElapsed();
+
+  // Advance all animations, collecting the updates they request
+  this->advancing = true;
+  this->advance();
+  this->advancing = false;
+  this->flushUpdates();
+
+  // Update statistics
+  auto& s = this->statistics;
+  auto const frameTime = this->clock.nsecsElapsed() - frameStart;
+  this->totalFrameTime += frameTime;
+  ++s.frameCount;
+  s.maxFrameTime = qMax(s.maxFrameTime, 1e-6 * frameTime);
+  s.meanFrameTime = 1e-6 * this->totalFrameTime / s.frameCount;
+
+  if (this->lastFrameStart >= 0)
+  {
+    auto const interval = frameStart - this->lastFrameStart;
+    auto const intervalMs = 1e-6 * interval;
+    this->totalInterval += interval;
+    s.maxInterval = qMax(s.maxInterval, intervalMs);
+    s.meanInterval = 1e-6 * this->totalInterval / (s.frameCount - 1);
+    if (intervalMs > 1.5e3 / this->frameRate)
+    {
+      ++s.lateFrameCount;
+    }
+  }
+  this->lastFrameStart = frameStart;
+
+  emit q->frameFinished();
+}
+
+//-----------------------------------------------------------------------------
+void qtAnimationDriverPrivate::flushUpdates()
+{
+  auto const updates = this->pendingUpdates;
+  this->pendingUpdates.clear();
+  this->pendingSet.clear();
+
+  foreach (auto const& widget, updates)
+  {
+    if (widget)
+    {
+      widget->update();
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+qtAnimationDriver::qtAnimationDriver(QObject* parent)
+  : QObject(parent), d_ptr(new qtAnimationDriverPrivate(this))
+{
+}
+
+//-----------------------------------------------------------------------------
+qtAnimationDriver::~qtAnimationDriver()
+{
+  this->uninstall();
+}
+
+//-----------------------------------------------------------------------------
+qtAnimationDriver* qtAnimationDriver::current()
+{
+  return currentDriver;
+}
+
+//-----------------------------------------------------------------------------
+void qtAnimationDriver::install()
+{
+  QTE_D();
+  d->install();
+  currentDriver = this;
+}
+
+//-----------------------------------------------------------------------------
+void qtAnimationDriver::uninstall()
+{
+  QTE_D();
+  if (currentDriver == this)
+  {
+    d->uninstall();
+    currentDriver = nullptr;
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool qtAnimationDriver::isInstalled() const
+{
+  return currentDriver == this;
+}
+
+//-----------------------------------------------------------------------------
+double qtAnimationDriver::frameRate() const
+{
+  QTE_D();
+  return d->frameRate;
+}
+
+//-----------------------------------------------------------------------------
+void qtAnimationDriver::setFrameRate(double frameRate)
+{
+  QTE_D();
+  if (frameRate > 0.0 && frameRate != d->frameRate)
+  {
+    d->frameRate = frameRate;
+    if (d->timer.isActive())
+    {
+      d->timer.setInterval(d->interval());
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+qtAnimationDriver::FrameStatistics qtAnimationDriver::statistics() const
+{
+  QTE_D();
+  return d->statistics;
+}
+
+//-----------------------------------------------------------------------------
+void qtAnimationDriver::resetStatistics()
+{
+  QTE_D();
+  d->statistics = {};
+  d->totalInterval = 0;
+  d->totalFrameTime = 0;
+  d->lastFrameStart = -1;
+}
+
+//-----------------------------------------------------------------------------
+void qtAnimationDriver::scheduleUpdate(QWidget* widget)
+{
+  auto* const driver = currentDriver;
+  if (!driver || !driver->d_func()->advancing)
+  {
+    widget->update();
+    return;
+  }
+
+  auto* const d = driver->d_func();
+  if (!d->pendingSet.contains(widget))
+  {
+    d->pendingSet.insert(widget);
+    d->pendingUpdates.append(widget);
+  }
+}
@@ -0,0 +1,112 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#ifndef __qtAnimationDriver_h
+#define __qtAnimationDriver_h
+
+#include <QObject>
+
+#include "../core/qtGlobal.h"
+
+class QWidget;
+
+class qtAnimationDriverPrivate;
+
+/// Frame-synchronized clock for animations.
+///
+/// qtAnimationDriver replaces Qt's default animation timer for the thread in
+/// which it is installed. While installed, every animation on that thread
+/// (including every qtAbstractAnimation, and Qt's own QPropertyAnimation and
+/// similar) is advanced from a single clock, at a configurable frame rate, in
+/// one batch per frame. The clock only runs while at least one animation is
+/// running.
+///
+/// Animations that repaint widgets should request the repaint using
+/// scheduleUpdate(). When a driver is ticking, updates requested during a
+/// frame are collected and issued together after all animations have been
+/// advanced, so that all animated widgets are repainted in the same pass.
+///
+/// The driver also collects statistics on frame intervals and on the time
+/// spent advancing animations, which can be used to detect dropped frames.
+class QTE_EXPORT qtAnimationDriver : public QObject
+{
+  Q_OBJECT
+
+  Q_PROPERTY(double frameRate READ frameRate WRITE setFrameRate)
+
+public:
+  /// Frame timing statistics.
+  ///
+  /// All times are in milliseconds.
+  struct FrameStatistics
+  {
+    /// Number of frames since the statistics were last reset.
+    int frameCount = 0;
+    /// Number of frames which started more than 1.5 frame intervals after
+    /// the previous frame.
+    int lateFrameCount = 0;
+
+    /// Mean and maximum time between the start of consecutive frames.
+    double meanInterval = 0.0;
+    double maxInterval = 0.0;
+
+    /// Mean and maximum time spent advancing animations and issuing
+    /// updates.
+    double meanFrameTime = 0.0;
+    double maxFrameTime = 0.0;
+  };
+
+  explicit qtAnimationDriver(QObject* parent = 0);
+  virtual ~qtAnimationDriver();
+
+  /// Get the driver installed in the calling thread, or \c nullptr.
+  static qtAnimationDriver* current();
+
+  /// Install the driver in the calling thread.
+  ///
+  /// This replaces any previously installed driver.
+  void install();
+
+  /// Uninstall the driver, restoring Qt's default animation timer.
+  void uninstall();
+
+  /// Test if the driver is installed.
+  bool isInstalled() const;
+
+  /// Get the target frame rate, in frames per second.
+  double frameRate() const;
+
+  /// Set the target frame rate, in frames per second.
+  ///
+  /// The default is 60 frames per second.
+  void setFrameRate(double);
+
+  /// Get the frame timing statistics.
+  FrameStatistics statistics() const;
+
+  /// Reset the frame timing statistics.
+  void resetStatistics();
+
+  /// Request an update of a widget.
+  ///
+  /// If a driver is installed in the calling thread and is currently
+  /// advancing animations, the update is deferred until all animations have
+  /// been advanced; multiple requests for the same widget in a frame result
+  /// in a single update. Otherwise, QWidget::update() is called immediately.
+  static void scheduleUpdate(QWidget*);
+
+signals:
+  /// Emitted after each frame has been advanced and updates have been
+  /// issued.
+  void frameFinished();
+
+protected:
+  QTE_DECLARE_PRIVATE_RPTR(qtAnimationDriver)
+
+private:
+  QTE_DECLARE_PRIVATE(qtAnimationDriver)
+  QTE_DISABLE_COPY(qtAnimationDriver)
+};
+
+#endif
@@ -4,6 +4,53 @@
 
 #include "qtColorUtil.h"
 
+#include <cmath>
+
+namespace // anonymous
+{
+
+//-----------------------------------------------------------------------------
+inline float clamp(float x)
+{
+  return (x > 0.0f ? (x < 1.0f ? x : 1.0f) : 0.0f);
+}
+
+//-----------------------------------------------------------------------------
+inline qreal clampHue(float h)
+{
+  // QColor rejects hues outside [0, 1], except -1 (achromatic)
+  return (h < 0.0f ? -1.0 : static_cast<qreal>(h < 1.0f ? h : 1.0f));
+}
+
+//-----------------------------------------------------------------------------
+void hueToRgb(float h, float c, float m, float* rgb)
+{
+  // Compute RGB from hue, chroma and lightness offset
+  if (h < 0.0f)
+    {
+    rgb[0] = rgb[1] = rgb[2] = m + c;
+    return;
+    }
+
+  auto const hp = (h >= 1.0f ? 0.0f : h * 6.0f);
+  auto const x = c * (1.0f - std::fabs(std::fmod(hp, 2.0f) - 1.0f));
+  float r, g, b;
+  switch (static_cast<int>(hp))
+    {
+    case 0:  r = c; g = x; b = 0; break;
+    case 1:  r = x; g = c; b = 0; break;
+    case 2:  r = 0; g = c; b = x; break;
+    case 3:  r = 0; g = x; b = c; break;
+    case 4:  r = x; g = 0; b = c; break;
+    default: r = c; g = 0; b = x; break;
+    }
+  rgb[0] = r + m;
+  rgb[1] = g + m;
+  rgb[2] = b + m;
+}
+
+} // namespace <anonymous>
+
 namespace qtColorUtil
 {
 
@@ -32,37 +79,20 @@ qreal blend(qreal p0, qreal p1, qreal p2, qreal p3, qreal t)
 //-----------------------------------------------------------------------------
 QColor blend(const QColor& a, const QColor& b, qreal t, QColor::Spec s)
 {
-  QColor result;
-
-  switch (s)
+  if (s != QColor::Cmyk)
     {
-    case QColor::Cmyk:
-      result.setCmykF(
-        blend(a.cyanF(),    b.cyanF(),    t),
-        blend(a.magentaF(), b.magentaF(), t),
-        blend(a.yellowF(),  b.yellowF(),  t),
-        blend(a.blackF(),   b.blackF(),   t));
-      break;
-    case QColor::Hsv:
-      result.setHsvF(
-        blend(a.hsvHueF(),        b.hsvHueF(),        t),
-        blend(a.hsvSaturationF(), b.hsvSaturationF(), t),
-        blend(a.valueF(),         b.valueF(),         t));
-      break;
-    case QColor::Hsl:
-      result.setHslF(
-        blend(a.hslHueF(),        b.hslHueF(),        t),
-        blend(a.hslSaturationF(), b.hslSaturationF(), t),
-        blend(a.lightnessF(),     b.lightnessF(),     t));
-      break;
-    default: // RGB
-      result.setRgbF(
-        blend(a.redF(),   b.redF(),   t),
-        blend(a.greenF(), b.greenF(), t),
-        blend(a.blueF(),  b.blueF(),  t));
-      break;
+    auto const& fa = toFloatColor(a, s);
+    auto const& fb = toFloatColor(b, s);
+    return toColor(blend(fa, fb, static_cast<float>(t)), s);
     }
 
+  QColor result;
+  result.setCmykF(
+    blend(a.cyanF(),    b.cyanF(),    t),
+    blend(a.magentaF(), b.magentaF(), t),
+    blend(a.yellowF(),  b.yellowF(),  t),
+    blend(a.blackF(),   b.blackF(),   t));
+
   // Blend alpha and return result
   result.setAlphaF(blend(a.alphaF(), b.alphaF(), t));
   return result;
@@ -74,30 +104,130 @@ QColor blend(const QColor& a, const QColor& b, qreal t, QColor::Spec s)
 QColor blend(const QColor& a, const QColor& b, const QColor& c,
              const QColor& d, qreal t, QColor::Spec s)
 {
+  if (s != QColor::Cmyk)
+    {
+    auto const& fa = toFloatColor(a, s);
+    auto const& fb = toFloatColor(b, s);
+    auto const& fc = toFloatColor(c, s);
+    auto const& fd = toFloatColor(d, s);
+    return toColor(blend(fa, fb, fc, fd, static_cast<float>(t)), s);
+    }
+
   QColor result;
+  result.setCmykF(
+    BLEND4(cyan), BLEND4(magenta), BLEND4(yellow), BLEND4(black));
+
+  // Blend alpha and return result
+  result.setAlphaF(BLEND4(alpha));
+  return result;
+}
+#undef BLEND4
 
+//-----------------------------------------------------------------------------
+FloatColor toFloatColor(const QColor& color, QColor::Spec s)
+{
+  qreal c0, c1, c2, alpha;
   switch (s)
     {
-    case QColor::Cmyk:
-      result.setCmykF(
-        BLEND4(cyan), BLEND4(magenta), BLEND4(yellow), BLEND4(black));
+    case QColor::Hsv:
+      color.getHsvF(&c0, &c1, &c2, &alpha);
       break;
+    case QColor::Hsl:
+      color.getHslF(&c0, &c1, &c2, &alpha);
+      break;
+    default: // RGB
+      color.getRgbF(&c0, &c1, &c2, &alpha);
+      break;
+    }
+
+  return {{
+    static_cast<float>(c0), static_cast<float>(c1),
+    static_cast<float>(c2), static_cast<float>(alpha)
+  }};
+}
+
+//-----------------------------------------------------------------------------
+QColor toColor(const FloatColor& color, QColor::Spec s)
+{
+  auto const& v = color.v;
+  switch (s)
+    {
     case QColor::Hsv:
-      result.setHsvF(
-        BLEND4(hsvHue), BLEND4(hsvSaturation), BLEND4(value));
+      return QColor::fromHsvF(clampHue(v[0]), clamp(v[1]), clamp(v[2]),
+                              clamp(v[3]));
+    case QColor::Hsl:
+      return QColor::fromHslF(clampHue(v[0]), clamp(v[1]), clamp(v[2]),
+                              clamp(v[3]));
+    default: // RGB
+      return QColor::fromRgbF(clamp(v[0]), clamp(v[1]), clamp(v[2]),
+                              clamp(v[3]));
+    }
+}
+
+//-----------------------------------------------------------------------------
+FloatColor toRgbF(const FloatColor& color, QColor::Spec s)
+{
+  auto const& v = color.v;
+  FloatColor result;
+  result.v[3] = clamp(v[3]);
+
+  // As in QColor, a negative hue indicates an achromatic color, regardless of
+  // the saturation
+  auto const achromatic = (v[0] < 0.0f);
+
+  switch (s)
+    {
+    case QColor::Hsv:
+      {
+      auto const sat = (achromatic ? 0.0f : clamp(v[1]));
+      auto const val = clamp(v[2]);
+      auto const c = val * sat;
+      hueToRgb(v[0], c, val - c, result.v);
       break;
+      }
     case QColor::Hsl:
-      result.setHslF(
-        BLEND4(hslHue), BLEND4(hslSaturation), BLEND4(lightness));
+      {
+      auto const sat = (achromatic ? 0.0f : clamp(v[1]));
+      auto const light = clamp(v[2]);
+      auto const c = (1.0f - std::fabs((2.0f * light) - 1.0f)) * sat;
+      hueToRgb(v[0], c, light - (0.5f * c), result.v);
       break;
+      }
     default: // RGB
-      result.setRgbF(BLEND4(red), BLEND4(green), BLEND4(blue));
+      result.v[0] = clamp(v[0]);
+      result.v[1] = clamp(v[1]);
+      result.v[2] = clamp(v[2]);
       break;
     }
 
-  // Blend alpha and return result
-  result.setAlphaF(BLEND4(alpha));
   return result;
 }
 
+//-----------------------------------------------------------------------------
+QRgb toRgba(const FloatColor& color, QColor::Spec s)
+{
+  auto const& rgb = toRgbF(color, s);
+  auto const k = [](float x){
+    return static_cast<int>((clamp(x) * 255.0f) + 0.5f);
+  };
+  return qRgba(k(rgb.v[0]), k(rgb.v[1]), k(rgb.v[2]), k(rgb.v[3]));
+}
+
+//-----------------------------------------------------------------------------
+void blend(const FloatColor& a, const FloatColor& b,
+           const float* t, int n, FloatColor* out)
+{
+  for (int i = 0; i < n; ++i)
+    out[i] = blend(a, b, t[i]);
+}
+
+//-----------------------------------------------------------------------------
+void blend(const FloatColor& a, const FloatColor& b,
+           const FloatColor& c, const FloatColor& d,
+           const float* t, int n, FloatColor* out)
+{
+  for (int i = 0; i < n; ++i)
+    out[i] = blend(a, b, c, d, t[i]);
+}
+
 } // namespace qtColorUtil
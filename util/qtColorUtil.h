@@ -11,6 +11,15 @@
 
 namespace qtColorUtil
 {
+  // Color with floating point components, in RGB, HSV or HSL space; the
+  // components are stored in the order used by QColor (e.g. hue, saturation,
+  // value), followed by alpha. As with QColor, a hue of -1 indicates an
+  // achromatic color.
+  struct FloatColor
+  {
+    float v[4];
+  };
+
   QTE_EXPORT qreal blend(qreal a, qreal b, qreal t);
   QTE_EXPORT qreal blend(qreal a, qreal b, qreal c, qreal d, qreal t);
   QTE_EXPORT QColor blend(const QColor& a, const QColor& b,
@@ -18,6 +27,66 @@ namespace qtColorUtil
   QTE_EXPORT QColor blend(const QColor& a, const QColor& b,
                           const QColor& c, const QColor& d,
                           qreal t, QColor::Spec s = QColor::Rgb);
+
+  // Conversions between QColor and FloatColor; spec must be one of
+  // QColor::Rgb, QColor::Hsv or QColor::Hsl
+  QTE_EXPORT FloatColor toFloatColor(const QColor& color,
+                                     QColor::Spec s = QColor::Rgb);
+  QTE_EXPORT QColor toColor(const FloatColor& color,
+                            QColor::Spec s = QColor::Rgb);
+  QTE_EXPORT QRgb toRgba(const FloatColor& color,
+                         QColor::Spec s = QColor::Rgb);
+  QTE_EXPORT FloatColor toRgbF(const FloatColor& color, QColor::Spec s);
+
+  inline FloatColor blend(const FloatColor& a, const FloatColor& b, float t);
+  inline FloatColor blend(const FloatColor& a, const FloatColor& b,
+                          const FloatColor& c, const FloatColor& d, float t);
+
+  // Batch blends; these compute out[i] = blend(..., t[i]) for each of the
+  // n elements of t
+  QTE_EXPORT void blend(const FloatColor& a, const FloatColor& b,
+                        const float* t, int n, FloatColor* out);
+  QTE_EXPORT void blend(const FloatColor& a, const FloatColor& b,
+                        const FloatColor& c, const FloatColor& d,
+                        const float* t, int n, FloatColor* out);
+}
+
+//-----------------------------------------------------------------------------
+qtColorUtil::FloatColor qtColorUtil::blend(
+  const FloatColor& a, const FloatColor& b, float t)
+{
+  auto const u = 1.0f - t;
+  return {{
+    (a.v[0] * u) + (b.v[0] * t),
+    (a.v[1] * u) + (b.v[1] * t),
+    (a.v[2] * u) + (b.v[2] * t),
+    (a.v[3] * u) + (b.v[3] * t)
+  }};
+}
+
+//-----------------------------------------------------------------------------
+qtColorUtil::FloatColor qtColorUtil::blend(
+  const FloatColor& a, const FloatColor& b,
+  const FloatColor& c, const FloatColor& d, float t)
+{
+  // Catmull-Rom spline through b and c, clamped to [0, 1]
+  auto const t2 = t * t;
+  auto const t3 = t2 * t;
+
+  auto const a0 =  2.0f * t3 + -3.0f * t2 + 1.0f;
+  auto const a1 =  1.0f * t3 + -2.0f * t2 + t;
+  auto const a2 =  1.0f * t3 + -1.0f * t2;
+  auto const a3 = -2.0f * t3 +  3.0f * t2;
+
+  FloatColor result;
+  for (int i = 0; i < 4; ++i)
+    {
+    auto const m0 = (c.v[i] - a.v[i]) * 0.5f;
+    auto const m1 = (d.v[i] - b.v[i]) * 0.5f;
+    auto const x = (a0 * b.v[i]) + (a1 * m0) + (a2 * m1) + (a3 * c.v[i]);
+    result.v[i] = (x > 0.0f ? (x < 1.0f ? x : 1.0f) : 0.0f);
+    }
+  return result;
 }
 
 #endif
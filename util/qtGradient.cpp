@@ -4,25 +4,139 @@
 
 #include "qtGradient.h"
 
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QSharedData>
+#include <QVector>
 
 #include "../core/qtIndexRange.h"
 #include "../core/qtMath.h"
+#include "../core/qtParallel.h"
 
 #include "qtColorUtil.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+// The batch mapping kernels are selected at compile time; defining
+// QTE_GRADIENT_NO_SIMD forces the portable implementation (e.g. for testing)
+#if defined(QTE_GRADIENT_NO_SIMD)
+   // Use the scalar kernels
+#elif defined(__AVX2__)
+#  include <immintrin.h>
+#  define QTE_GRADIENT_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || \
+      (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define QTE_GRADIENT_SSE2
+#endif
+
 QTE_IMPLEMENT_D_FUNC_SHARED(qtGradient)
 
 //BEGIN qtGradientData
 
+namespace // anonymous
+{
+
+using qtColorUtil::FloatColor;
+
+//-----------------------------------------------------------------------------
+// Compute the polynomial coefficients (constant term first) of the
+// Catmull-Rom spline through p1 and p2, as evaluated by qtColorUtil::blend
+template <typename T>
+void catmullRom(T p0, T p1, T p2, T p3, T* out)
+{
+    auto const m0 = (p2 - p0) * T(0.5);
+    auto const m1 = (p3 - p1) * T(0.5);
+    out[0] = p1;
+    out[1] = m0;
+    out[2] = (T(-3) * p1) - (T(2) * m0) - m1 + (T(3) * p2);
+    out[3] = (T(2) * p1) + m0 + m1 - (T(2) * p2);
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+inline T evaluatePolynomial(T const* c, T t)
+{
+    return (((((c[3] * t) + c[2]) * t) + c[1]) * t) + c[0];
+}
+
+//-----------------------------------------------------------------------------
+inline FloatColor average(FloatColor const& a, FloatColor const& b)
+{
+    return qtColorUtil::blend(a, b, 0.5f);
+}
+
+} // namespace <anonymous>
+
 //-----------------------------------------------------------------------------
 class qtGradientData : public QSharedData
 {
 public:
-    QMap<qreal, qtGradient::Stop> stops;
+    // Coefficients for one half (before or after the weight point) of a cubic
+    // segment; the position is remapped through one spline, and the color is
+    // computed from another
+    struct CubicHalf
+    {
+        qreal position[4];
+        float color[4][4];
+    };
+
+    // Precomputed coefficients for the span between two adjacent stops
+    struct Segment
+    {
+        qreal lower;
+        qreal scale; // 1 / (upper - lower)
+        qreal weight;
+        qreal lowerScale; // 1 / weight
+        qreal upperScale; // 1 / (1 - weight)
+
+        FloatColor lowerColor;
+        FloatColor upperColor;
+
+        CubicHalf cubic[2];
+    };
+
+    qtGradientData() : segmentsValid{false} {}
+    qtGradientData(qtGradientData const& other)
+        : QSharedData{other}, stops{other.stops},
+          interpolateMode{other.interpolateMode}, spread{other.spread},
+          segmentsValid{false}
+    {}
+
+    // Stops, sorted by position
+    QVector<qtGradient::Stop> stops;
     qtGradient::InterpolationMode interpolateMode;
     qtGradient::Spread spread;
 
+    // Per-segment coefficients (and stop colors in the blend color space);
+    // these depend only on the stops and interpolation mode, and are rebuilt
+    // on demand after either changes
+    mutable QMutex segmentsMutex;
+    mutable std::atomic<bool> segmentsValid;
+    mutable QVector<Segment> segments;
+    mutable QVector<FloatColor> stopColors;
+
+    // Baked lookup tables, by size; these are invalidated along with the
+    // segments
+    mutable QMutex lookupTablesMutex;
+    mutable QHash<int, qtGradient::LookupTable> lookupTables;
+
+    int find(qreal pos) const;
+    int findSegment(qreal pos, int& stop) const;
+    bool insert(qtGradient::Stop const& stop);
+    void invalidate();
+
+    void updateSegments() const;
+    void buildSegments() const;
+
+    QColor colorAt(qreal pos) const;
+    FloatColor floatColorAt(qreal pos) const;
+    FloatColor evaluate(Segment const& segment, qreal pos) const;
+
     QColor blend(QColor const& a, QColor const& b, qreal t) const;
     QColor linearBlend(QColor const& a, QColor const& b,
                        qreal t, qreal w) const;
@@ -33,6 +147,251 @@ public:
     QColor::Spec blendSpace() const;
 };
 
+//-----------------------------------------------------------------------------
+int qtGradientData::find(qreal pos) const
+{
+    // Find the first stop whose position is not less than pos
+    auto const iter = std::lower_bound(
+        stops.constBegin(), stops.constEnd(), pos,
+        [](qtGradient::Stop const& stop, qreal p){
+            return stop.position < p;
+        });
+    return static_cast<int>(iter - stops.constBegin());
+}
+
+//-----------------------------------------------------------------------------
+int qtGradientData::findSegment(qreal pos, int& stop) const
+{
+    // Find next stop; positions outside of the stops use the nearest stop
+    auto const su = find(pos);
+    if (su >= stops.count())
+    {
+        stop = su - 1;
+        return -1;
+    }
+
+    // Check for exact (or 'close enough') match
+    if (su == 0 || qFuzzyCompare(pos, stops[su].position))
+    {
+        stop = su;
+        return -1;
+    }
+
+    // Check (again) for exact (or 'close enough') match, this time against the
+    // previous stop (in case we are off 'just enough' that the search didn't
+    // consider it a match)
+    if (qFuzzyCompare(pos, stops[su - 1].position))
+    {
+        stop = su - 1;
+        return -1;
+    }
+
+    return su - 1;
+}
+
+//-----------------------------------------------------------------------------
+bool qtGradientData::insert(qtGradient::Stop const& stop)
+{
+    // Replace any stop at the same position, as a map would
+    auto const i = find(stop.position);
+    if (i < stops.count() && stops[i].position == stop.position)
+    {
+        stops[i] = stop;
+        return false;
+    }
+
+    stops.insert(i, stop);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void qtGradientData::invalidate()
+{
+    // Only called on a detached instance, so no other thread can be reading
+    // the caches
+    segmentsValid.store(false, std::memory_order_relaxed);
+    segments.clear();
+    stopColors.clear();
+    lookupTables.clear();
+}
+
+//-----------------------------------------------------------------------------
+void qtGradientData::updateSegments() const
+{
+    if (segmentsValid.load(std::memory_order_acquire))
+        return;
+
+    QMutexLocker lock{&segmentsMutex};
+    if (!segmentsValid.load(std::memory_order_relaxed))
+    {
+        buildSegments();
+        segmentsValid.store(true, std::memory_order_release);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qtGradientData::buildSegments() const
+{
+    auto const space = blendSpace();
+    auto const count = stops.count();
+
+    stopColors.resize(count);
+    for (int i = 0; i < count; ++i)
+        stopColors[i] = qtColorUtil::toFloatColor(stops[i].color, space);
+
+    segments.resize(qMax(0, count - 1));
+    for (int i = 0; i < count - 1; ++i)
+    {
+        auto& s = segments[i];
+
+        auto const& a = stops[qMax(0, i - 1)];
+        auto const& b = stops[i];
+        auto const& c = stops[i + 1];
+        auto const& d = stops[qMin(count - 1, i + 2)];
+
+        auto const w = b.weight;
+        s.lower = b.position;
+        s.scale = 1.0 / (c.position - b.position);
+        s.weight = w;
+        s.lowerScale = (w > 0.0 ? 1.0 / w : 0.0);
+        s.upperScale = (w < 1.0 ? 1.0 / (1.0 - w) : 0.0);
+
+        auto const& cb = stopColors[i];
+        auto const& cc = stopColors[i + 1];
+        s.lowerColor = cb;
+        s.upperColor = cc;
+
+        // Calculate intermediary stops
+        auto const& ca = average(stopColors[qMax(0, i - 1)], cb);
+        auto const& cd = average(stopColors[qMin(count - 1, i + 2)], cc);
+        auto const& cm = average(cb, cc);
+        auto const pb = b.position, pc = c.position;
+        auto const pa = qtColorUtil::blend(a.position, pb, a.weight);
+        auto const pd = qtColorUtil::blend(d.position, pc, c.weight);
+        auto const pm = qtColorUtil::blend(pb, pc, w);
+
+        // Build splines for each half; the position splines are folded
+        // together with the subsequent normalization
+        FloatColor const* const colors[2][4] = {
+            {&ca, &cb, &cm, &cc},
+            {&cb, &cm, &cc, &cd},
+        };
+        qreal const positions[2][4] = {
+            {pa, pb, pm, pc},
+            {pb, pm, pc, pd},
+        };
+        for (int h = 0; h < 2; ++h)
+        {
+            auto& half = s.cubic[h];
+            auto const* const p = positions[h];
+            auto const range = p[2] - p[1];
+            auto const k = (range > 0.0 ? 1.0 / range : 0.0);
+
+            catmullRom(p[0], p[1], p[2], p[3], half.position);
+            half.position[0] -= p[1];
+            for (auto& coefficient : half.position)
+                coefficient *= k;
+
+            auto const& cl = colors[h];
+            for (int n = 0; n < 4; ++n)
+            {
+                catmullRom(cl[0]->v[n], cl[1]->v[n], cl[2]->v[n], cl[3]->v[n],
+                           half.color[n]);
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+FloatColor qtGradientData::evaluate(Segment const& s, qreal pos) const
+{
+    auto const rpos = (pos - s.lower) * s.scale;
+
+    switch (interpolateMode & qtGradient::InterpolateFunctionMask)
+    {
+        case qtGradient::InterpolateDiscrete:
+            return (rpos < s.weight ? s.lowerColor : s.upperColor);
+
+        case qtGradient::InterpolateCubic:
+        {
+            auto const upper = (rpos > s.weight);
+            auto const& half = s.cubic[upper ? 1 : 0];
+            auto const t = (upper ? (rpos - s.weight) * s.upperScale
+                                  : rpos * s.lowerScale);
+            auto const u = static_cast<float>(
+                qBound(0.0, evaluatePolynomial(half.position, t), 1.0));
+
+            FloatColor result;
+            for (int n = 0; n < 4; ++n)
+            {
+                auto const x = evaluatePolynomial(half.color[n], u);
+                result.v[n] = (x > 0.0f ? (x < 1.0f ? x : 1.0f) : 0.0f);
+            }
+            return result;
+        }
+
+        default: // qtGradient::InterpolateLinear
+        {
+            // Apply weighting
+            auto const t = (rpos > s.weight
+                            ? 0.5 + (0.5 * (rpos - s.weight) * s.upperScale)
+                            : 0.5 * rpos * s.lowerScale);
+
+            // Perform blend
+            return qtColorUtil::blend(s.lowerColor, s.upperColor,
+                                      static_cast<float>(t));
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+FloatColor qtGradientData::floatColorAt(qreal pos) const
+{
+    updateSegments();
+
+    int stop;
+    auto const segment = findSegment(pos, stop);
+    return (segment < 0 ? stopColors[stop]
+                        : evaluate(segments[segment], pos));
+}
+
+//-----------------------------------------------------------------------------
+QColor qtGradientData::colorAt(qreal pos) const
+{
+    int stop;
+    auto const segment = findSegment(pos, stop);
+    if (segment < 0)
+        return stops[stop].color;
+
+    // CMYK blending is not supported by the precomputed segments
+    auto const space = blendSpace();
+    if (space == QColor::Cmyk)
+    {
+        auto const& sl = stops[segment];
+        auto const& su = stops[segment + 1];
+        auto const rpos = (pos - sl.position) / (su.position - sl.position);
+
+        switch (interpolateMode & qtGradient::InterpolateFunctionMask)
+        {
+            case qtGradient::InterpolateDiscrete:
+                return (rpos < sl.weight ? sl.color : su.color);
+
+            case qtGradient::InterpolateCubic:
+            {
+                auto const& sll = stops[qMax(0, segment - 1)];
+                auto const& suu = stops[qMin(stops.count() - 1, segment + 2)];
+                return cubicBlend(sll, sl, su, suu, rpos);
+            }
+
+            default: // qtGradient::InterpolateLinear
+                return linearBlend(sl.color, su.color, rpos, sl.weight);
+        }
+    }
+
+    updateSegments();
+    return qtColorUtil::toColor(evaluate(segments[segment], pos), space);
+}
+
 //-----------------------------------------------------------------------------
 QColor::Spec qtGradientData::blendSpace() const
 {
@@ -103,6 +462,350 @@ QColor qtGradientData::cubicBlend(
 
 ///////////////////////////////////////////////////////////////////////////////
 
+//BEGIN batch mapping
+
+namespace // anonymous
+{
+
+// Size of the lookup table used by qtGradient::map; 4096 entries is well
+// beyond what can be distinguished visually, while still fitting in L1/L2
+constexpr int mapTableSize = 4096;
+
+// Values are converted (if needed) and mapped in blocks of this size
+constexpr int mapBlockSize = 1024;
+
+// Inputs at least this large are split across the global thread pool
+constexpr int mapParallelThreshold = 1 << 17;
+constexpr int mapParallelChunk = 1 << 15;
+
+//-----------------------------------------------------------------------------
+template <QGradient::Spread Spread>
+inline float applySpread(float t)
+{
+    switch (Spread)
+    {
+        case QGradient::RepeatSpread:
+            return t - std::floor(t);
+        case QGradient::ReflectSpread:
+        {
+            auto const m = t - (2.0f * std::floor(0.5f * t));
+            return 1.0f - std::fabs(1.0f - m);
+        }
+        default:
+            // Clamping is done when the index is computed
+            return t;
+    }
+}
+
+//-----------------------------------------------------------------------------
+template <QGradient::Spread Spread>
+void mapScalar(float const* values, int n, float offset, float scale,
+               QRgb const* lut, QRgb nanColor, QRgb* out)
+{
+    auto const last = static_cast<float>(mapTableSize - 1);
+    for (int i = 0; i < n; ++i)
+    {
+        auto const v = values[i];
+        if (std::isnan(v))
+        {
+            out[i] = nanColor;
+            continue;
+        }
+
+        auto const t = applySpread<Spread>((v - offset) * scale);
+        auto const x = (t * last) + 0.5f;
+        out[i] = lut[x > 0.0f ? (x < last ? static_cast<int>(x)
+                                          : mapTableSize - 1) : 0];
+    }
+}
+
+#if defined(QTE_GRADIENT_AVX2)
+
+//-----------------------------------------------------------------------------
+template <QGradient::Spread Spread>
+inline __m256 applySpread(__m256 t)
+{
+    auto const one = _mm256_set1_ps(1.0f);
+    switch (Spread)
+    {
+        case QGradient::RepeatSpread:
+            return _mm256_sub_ps(t, _mm256_floor_ps(t));
+        case QGradient::ReflectSpread:
+        {
+            auto const half = _mm256_set1_ps(0.5f);
+            auto const two = _mm256_set1_ps(2.0f);
+            auto const sign = _mm256_set1_ps(-0.0f);
+            auto const f = _mm256_floor_ps(_mm256_mul_ps(t, half));
+            auto const m = _mm256_sub_ps(t, _mm256_mul_ps(two, f));
+            auto const d = _mm256_andnot_ps(sign, _mm256_sub_ps(one, m));
+            return _mm256_sub_ps(one, d);
+        }
+        default:
+            return t;
+    }
+}
+
+//-----------------------------------------------------------------------------
+template <QGradient::Spread Spread>
+void mapVector(float const* values, int n, float offset, float scale,
+               QRgb const* lut, QRgb nanColor, QRgb* out)
+{
+    auto const vOffset = _mm256_set1_ps(offset);
+    auto const vScale = _mm256_set1_ps(scale);
+    auto const vLast = _mm256_set1_ps(static_cast<float>(mapTableSize - 1));
+    auto const vHalf = _mm256_set1_ps(0.5f);
+    auto const vZero = _mm256_setzero_ps();
+    auto const vNan = _mm256_set1_epi32(static_cast<int>(nanColor));
+    auto const* const table = reinterpret_cast<int const*>(lut);
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        auto const v = _mm256_loadu_ps(values + i);
+        auto const nanMask = _mm256_cmp_ps(v, v, _CMP_UNORD_Q);
+
+        auto t = _mm256_mul_ps(_mm256_sub_ps(v, vOffset), vScale);
+        t = applySpread<Spread>(t);
+
+        // Note: max returns its second operand if either is NaN, so NaN
+        // lanes produce index 0 here and are replaced below
+        auto x = _mm256_add_ps(_mm256_mul_ps(t, vLast), vHalf);
+        x = _mm256_min_ps(_mm256_max_ps(x, vZero), vLast);
+
+        auto const index = _mm256_cvttps_epi32(x);
+        auto const color = _mm256_i32gather_epi32(table, index, 4);
+        auto const result = _mm256_blendv_epi8(
+            color, vNan, _mm256_castps_si256(nanMask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), result);
+    }
+
+    mapScalar<Spread>(values + i, n - i, offset, scale, lut, nanColor,
+                      out + i);
+}
+
+#elif defined(QTE_GRADIENT_SSE2)
+
+//-----------------------------------------------------------------------------
+inline __m128 floorPs(__m128 t)
+{
+    // SSE2 has no floor; truncate, then correct negative non-integers. Values
+    // of magnitude 2^23 or more are already integers (or infinite), and are
+    // passed through, as the truncation would overflow.
+    auto const one = _mm_set1_ps(1.0f);
+    auto const limit = _mm_set1_ps(8388608.0f);
+    auto const sign = _mm_set1_ps(-0.0f);
+    auto const f = _mm_cvtepi32_ps(_mm_cvttps_epi32(t));
+    auto const r = _mm_sub_ps(f, _mm_and_ps(_mm_cmpgt_ps(f, t), one));
+    auto const small = _mm_cmplt_ps(_mm_andnot_ps(sign, t), limit);
+    return _mm_or_ps(_mm_and_ps(small, r), _mm_andnot_ps(small, t));
+}
+
+//-----------------------------------------------------------------------------
+template <QGradient::Spread Spread>
+inline __m128 applySpread(__m128 t)
+{
+    auto const one = _mm_set1_ps(1.0f);
+    switch (Spread)
+    {
+        case QGradient::RepeatSpread:
+            return _mm_sub_ps(t, floorPs(t));
+        case QGradient::ReflectSpread:
+        {
+            auto const half = _mm_set1_ps(0.5f);
+            auto const two = _mm_set1_ps(2.0f);
+            auto const sign = _mm_set1_ps(-0.0f);
+            auto const f = floorPs(_mm_mul_ps(t, half));
+            auto const m = _mm_sub_ps(t, _mm_mul_ps(two, f));
+            auto const d = _mm_andnot_ps(sign, _mm_sub_ps(one, m));
+            return _mm_sub_ps(one, d);
+        }
+        default:
+            return t;
+    }
+}
+
+//-----------------------------------------------------------------------------
+template <QGradient::Spread Spread>
+void mapVector(float const* values, int n, float offset, float scale,
+               QRgb const* lut, QRgb nanColor, QRgb* out)
+{
+    auto const vOffset = _mm_set1_ps(offset);
+    auto const vScale = _mm_set1_ps(scale);
+    auto const vLast = _mm_set1_ps(static_cast<float>(mapTableSize - 1));
+    auto const vHalf = _mm_set1_ps(0.5f);
+    auto const vZero = _mm_setzero_ps();
+    auto const vNan = _mm_set1_epi32(static_cast<int>(nanColor));
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        auto const v = _mm_loadu_ps(values + i);
+        auto const nanMask = _mm_castps_si128(_mm_cmpunord_ps(v, v));
+
+        auto t = _mm_mul_ps(_mm_sub_ps(v, vOffset), vScale);
+        t = applySpread<Spread>(t);
+
+        // Note: max returns its second operand if either is NaN, so NaN
+        // lanes produce index 0 here and are replaced below
+        auto x = _mm_add_ps(_mm_mul_ps(t, vLast), vHalf);
+        x = _mm_min_ps(_mm_max_ps(x, vZero), vLast);
+
+        // SSE2 has no gather, so look up the colors individually
+        alignas(16) int index[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(index),
+                        _mm_cvttps_epi32(x));
+        auto const color = _mm_setr_epi32(
+            static_cast<int>(lut[index[0]]), static_cast<int>(lut[index[1]]),
+            static_cast<int>(lut[index[2]]), static_cast<int>(lut[index[3]]));
+
+        auto const result = _mm_or_si128(_mm_and_si128(nanMask, vNan),
+                                         _mm_andnot_si128(nanMask, color));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+    }
+
+    mapScalar<Spread>(values + i, n - i, offset, scale, lut, nanColor,
+                      out + i);
+}
+
+#else
+
+//-----------------------------------------------------------------------------
+template <QGradient::Spread Spread>
+void mapVector(float const* values, int n, float offset, float scale,
+               QRgb const* lut, QRgb nanColor, QRgb* out)
+{
+    mapScalar<Spread>(values, n, offset, scale, lut, nanColor, out);
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+// Map float values with the kernel for the table's spread mode
+void mapValues(qtGradient::LookupTable const& lut, float const* values,
+               int n, float offset, float scale, QRgb nanColor, QRgb* out)
+{
+    switch (lut.spreadMode())
+    {
+        case QGradient::RepeatSpread:
+            mapVector<QGradient::RepeatSpread>(
+                values, n, offset, scale, lut.colors(), nanColor, out);
+            break;
+        case QGradient::ReflectSpread:
+            mapVector<QGradient::ReflectSpread>(
+                values, n, offset, scale, lut.colors(), nanColor, out);
+            break;
+        default:
+            mapVector<QGradient::PadSpread>(
+                values, n, offset, scale, lut.colors(), nanColor, out);
+            break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Apply a mapping function over a range of values, splitting large inputs
+// across the global thread pool
+template <typename Function>
+void mapRange(int n, Function function)
+{
+    if (n < mapParallelThreshold)
+    {
+        function(0, n);
+        return;
+    }
+
+    auto const chunks = (n + mapParallelChunk - 1) / mapParallelChunk;
+    qtParallel::forEach(qtIndexRange(chunks), [&](int chunk){
+        auto const first = chunk * mapParallelChunk;
+        function(first, std::min(n, first + mapParallelChunk) - first);
+    }, 1);
+}
+
+//-----------------------------------------------------------------------------
+// Map values of a type other than float, by converting blocks of values to
+// normalized floats
+template <typename T, typename Converter>
+void mapConverted(qtGradient::LookupTable const& lut, T const* values, int n,
+                  Converter convert, float offset, float scale,
+                  QRgb nanColor, QRgb* out)
+{
+    mapRange(n, [&](int first, int count){
+        float buffer[mapBlockSize];
+        for (int i = 0; i < count; i += mapBlockSize)
+        {
+            auto const k = std::min(mapBlockSize, count - i);
+            auto const* const in = values + first + i;
+            for (int j = 0; j < k; ++j)
+                buffer[j] = convert(in[j]);
+            mapValues(lut, buffer, k, offset, scale, nanColor,
+                      out + first + i);
+        }
+    });
+}
+
+//-----------------------------------------------------------------------------
+// Apply a function to each row of an image, splitting large images across the
+// global thread pool
+template <typename Function>
+void forEachRow(QImage& image, Function function)
+{
+    auto const rows = qtIndexRange(image.height());
+    if (image.width() * image.height() < mapParallelThreshold)
+    {
+        foreach (auto const y, rows)
+            function(y);
+        return;
+    }
+
+    auto const grain = qMax(1, mapParallelChunk / qMax(1, image.width()));
+    qtParallel::forEach(rows, function, grain);
+}
+
+//-----------------------------------------------------------------------------
+// Convert an image rendered as Format_ARGB32 to the requested format
+void finishImage(QImage& image, QImage::Format format)
+{
+    switch (format)
+    {
+        case QImage::Format_ARGB32:
+            break;
+
+        case QImage::Format_ARGB32_Premultiplied:
+        case QImage::Format_RGB32:
+        {
+            auto const premultiply =
+                (format == QImage::Format_ARGB32_Premultiplied);
+            auto const width = image.width();
+            auto* const bits = image.bits(); // Detach before sharing
+            auto const stride = image.bytesPerLine();
+            forEachRow(image, [=](int y){
+                auto* const row = reinterpret_cast<QRgb*>(bits + (y * stride));
+                if (premultiply)
+                {
+                    for (int x = 0; x < width; ++x)
+                        row[x] = qPremultiply(row[x]);
+                }
+                else
+                {
+                    for (int x = 0; x < width; ++x)
+                        row[x] |= 0xff000000;
+                }
+            });
+            image.reinterpretAsFormat(format);
+            break;
+        }
+
+        default:
+            image = image.convertToFormat(format);
+            break;
+    }
+}
+
+} // namespace <anonymous>
+
+//END batch mapping
+
+///////////////////////////////////////////////////////////////////////////////
+
 //BEGIN qtGradient
 
 //-----------------------------------------------------------------------------
@@ -156,6 +859,7 @@ void qtGradient::setInterpolationMode(qtGradient::InterpolationMode im)
 {
     QTE_D_MUTABLE();
     d->interpolateMode = im;
+    d->invalidate();
 }
 
 //-----------------------------------------------------------------------------
@@ -176,7 +880,11 @@ void qtGradient::setSpread(qtGradient::Spread spread)
 QMap<qreal, qtGradient::Stop> qtGradient::stops() const
 {
     QTE_D_SHARED();
-    return d->stops;
+
+    QMap<qreal, qtGradient::Stop> result;
+    foreach (auto const& stop, d->stops)
+        result.insert(stop.position, stop);
+    return result;
 }
 
 //-----------------------------------------------------------------------------
@@ -184,66 +892,64 @@ void qtGradient::setStops(QList<qtGradient::Stop> const& stops,
                           qtGradient::NormalizeMode nm)
 {
     QTE_D_MUTABLE();
+    d->invalidate();
+    d->stops.clear();
 
     // Handle empty set
     if (stops.isEmpty())
-    {
-        d->stops.clear();
         return;
-    }
 
     // Handle set with exactly one stop
     if (stops.count() == 1)
     {
-        d->stops.clear();
-        d->stops.insert(0.0, stops.first());
+        auto stop = stops.first();
+        stop.position = 0.0;
+        d->stops.append(stop);
         return;
     }
 
-    // Convert to map
-    QMap<qreal, qtGradient::Stop> stopsMap;
+    // Sort stops
     foreach (auto stop, stops)
     {
-      stop.weight = qBound(0.0, stop.weight, 1.0);
-      stopsMap.insert(stop.position, stop);
+        stop.weight = qBound(0.0, stop.weight, 1.0);
+        d->insert(stop);
     }
 
     // Handle 'regular' stop sets, based on normalization mode
     if (nm == qtGradient::NormalizeStops)
     {
         // Calculate coefficients to normalize stops to [0.0, 1.0]
-        auto const offset = stopsMap.constBegin().key();
-        auto const scale = 1.0 / ((--stopsMap.constEnd()).key() - offset);
+        auto const offset = d->stops.first().position;
+        auto const scale = 1.0 / (d->stops.last().position - offset);
 
-        // Recreate stop set, normalized
-        d->stops.clear();
-        foreach (auto stop, stops)
-        {
+        // Normalize stops
+        for (auto& stop : d->stops)
             stop.position = (stop.position - offset) * scale;
-            d->stops.insert(stop.position, stop);
-        }
     }
     else
     {
-        QMap<qreal, qtGradient::Stop>::iterator iter;
-
         // Truncate stops outside of normalized range
-        while (!stopsMap.isEmpty() && (iter = stopsMap.begin()).key() < 0.0)
-            stopsMap.erase(iter);
-        while (!stopsMap.isEmpty() && (iter = stopsMap.end()).key() > 1.0)
-            stopsMap.erase(iter);
+        while (!d->stops.isEmpty() && d->stops.first().position < 0.0)
+            d->stops.removeFirst();
+        while (!d->stops.isEmpty() && d->stops.last().position > 1.0)
+            d->stops.removeLast();
 
         // Add stops at 0.0, 1.0 if needed
-        if (!stopsMap.isEmpty())
+        if (!d->stops.isEmpty())
         {
-            if ((iter = stopsMap.begin()).key() > 0.0)
-                stopsMap.insert(0.0, iter.value());
-            if ((iter = stopsMap.end()).key() < 1.0)
-                stopsMap.insert(1.0, iter.value());
+            if (d->stops.first().position > 0.0)
+            {
+                auto stop = d->stops.first();
+                stop.position = 0.0;
+                d->stops.prepend(stop);
+            }
+            if (d->stops.last().position < 1.0)
+            {
+                auto stop = d->stops.last();
+                stop.position = 1.0;
+                d->stops.append(stop);
+            }
         }
-
-        // Set stops to modified set
-        d->stops = stopsMap;
     }
 }
 
@@ -256,7 +962,8 @@ bool qtGradient::insertStop(qtGradient::Stop stop)
     QTE_D_MUTABLE();
 
     stop.weight = qBound(0.0, stop.weight, 1.0);
-    d->stops.insert(stop.position, stop);
+    d->insert(stop);
+    d->invalidate();
 
     return true;
 }
@@ -265,7 +972,15 @@ bool qtGradient::insertStop(qtGradient::Stop stop)
 bool qtGradient::removeStop(qreal position)
 {
     QTE_D_MUTABLE();
-    return (d->stops.remove(position) > 0);
+
+    auto const i = d->find(position);
+    if (i < d->stops.count() && d->stops[i].position == position)
+    {
+        d->stops.remove(i);
+        d->invalidate();
+        return true;
+    }
+    return false;
 }
 
 //-----------------------------------------------------------------------------
@@ -276,7 +991,7 @@ QColor qtGradient::at(qreal pos) const
     if (d->stops.isEmpty())
         return Qt::transparent;
     if (d->stops.count() < 2)
-        return d->stops.begin().value().color;
+        return d->stops.first().color;
 
     // Apply spread to get normalized position
     switch (d->spread)
@@ -294,52 +1009,247 @@ QColor qtGradient::at(qreal pos) const
             break;
     }
 
-    // Find next stop
-    auto const su = d->stops.lowerBound(pos);
+    return d->colorAt(pos);
+}
 
-    // Check for exact (or 'close enough') match
-    if (qFuzzyCompare(pos, su.key()))
-        return su.value().color;
+//-----------------------------------------------------------------------------
+QList<QColor> qtGradient::render(int size) const
+{
+    QList<QColor> out;
+    out.reserve(size);
 
-    // Find previous stop and calculate relative position
-    auto const sl = su - 1;
-    auto const rpos = (pos - sl.key()) / (su.key() - sl.key());
+    auto const k = static_cast<qreal>(1.0 / (size - 1));
+    foreach (auto const i, qtIndexRange(size))
+        out.append(at(static_cast<qreal>(i) * k));
 
-    // Check (again) for exact (or 'close enough') match, this time against the
-    // previous stop (in case we are off 'just enough' that lowerBound didn't
-    // consider it a match)
-    if (qFuzzyCompare(pos, sl.key()))
-        return sl.value().color;
+    return out;
+}
+
+//-----------------------------------------------------------------------------
+qtGradient::LookupTable qtGradient::lookupTable(int size) const
+{
+    QTE_D_SHARED();
+
+    LookupTable lut;
+    size = qMax(size, 1);
 
-    // Calculate blended color
-    switch (d->interpolateMode & qtGradient::InterpolateFunctionMask)
+    QMutexLocker lock{&d->lookupTablesMutex};
+    auto const iter = d->lookupTables.constFind(size);
+    if (iter != d->lookupTables.constEnd())
     {
-        case qtGradient::InterpolateDiscrete:
-            return (rpos < sl->weight ? sl->color : su->color);
+        lut = iter.value();
+    }
+    else
+    {
+        lut.rgb.resize(size);
+        lut.rgbaF.resize(4 * size);
 
-        case qtGradient::InterpolateCubic:
+        auto const k = (size > 1 ? 1.0 / (size - 1) : 0.0);
+        auto* rgbaF = lut.rgbaF.data();
+        auto const space = d->blendSpace();
+        foreach (auto const i, qtIndexRange(size))
         {
-            auto const sll = (sl == d->stops.begin() ? sl : sl - 1);
-            auto const suu = (su + 1 == d->stops.end() ? su : su + 1);
-            return d->cubicBlend(*sll, *sl, *su, *suu, rpos);
+            qtColorUtil::FloatColor color;
+            if (d->stops.isEmpty())
+            {
+                color = {{0.0f, 0.0f, 0.0f, 0.0f}};
+            }
+            else if (d->stops.count() < 2 || space == QColor::Cmyk)
+            {
+                auto const& c = (d->stops.count() < 2
+                                 ? d->stops.first().color
+                                 : d->colorAt(static_cast<qreal>(i) * k));
+                color = qtColorUtil::toFloatColor(c, QColor::Rgb);
+            }
+            else
+            {
+                color = qtColorUtil::toRgbF(
+                    d->floatColorAt(static_cast<qreal>(i) * k), space);
+            }
+
+            lut.rgb[i] = qtColorUtil::toRgba(color, QColor::Rgb);
+            for (auto const c : color.v)
+                *(rgbaF++) = c;
         }
 
-        default: // qtGradient::InterpolateLinear
-            return d->linearBlend(sl->color, su->color, rpos, sl->weight);
+        // Avoid unbounded growth if many sizes are requested
+        if (d->lookupTables.count() >= 8)
+            d->lookupTables.clear();
+        d->lookupTables.insert(size, lut);
     }
+    lock.unlock();
+
+    // Spread is not part of the cached table, since it does not affect the
+    // table contents
+    lut.spread = d->spread;
+    return lut;
 }
 
 //-----------------------------------------------------------------------------
-QList<QColor> qtGradient::render(int size) const
+void qtGradient::map(float const* values, int n, float lo, float hi,
+                     QRgb* out, QRgb nanColor) const
 {
-    QList<QColor> out;
-    out.reserve(size);
+    auto const& lut = this->lookupTable(mapTableSize);
+    auto const scale = (hi != lo ? 1.0f / (hi - lo) : 0.0f);
 
-    auto const k = static_cast<qreal>(1.0 / (size - 1));
-    foreach (auto const i, qtIndexRange(size))
-        out.append(at(static_cast<qreal>(i) * k));
+    mapRange(n, [&](int first, int count){
+        mapValues(lut, values + first, count, lo, scale, nanColor,
+                  out + first);
+    });
+}
 
-    return out;
+//-----------------------------------------------------------------------------
+void qtGradient::map(double const* values, int n, double lo, double hi,
+                     QRgb* out, QRgb nanColor) const
+{
+    auto const& lut = this->lookupTable(mapTableSize);
+    auto const scale = (hi != lo ? 1.0 / (hi - lo) : 0.0);
+
+    // Normalize in double precision, so that values with a large offset
+    // relative to their range do not lose precision
+    auto const convert = [lo, scale](double v){
+        return static_cast<float>((v - lo) * scale);
+    };
+    mapConverted(lut, values, n, convert, 0.0f, 1.0f, nanColor, out);
+}
+
+//-----------------------------------------------------------------------------
+void qtGradient::map(quint16 const* values, int n, float lo, float hi,
+                     QRgb* out) const
+{
+    auto const& lut = this->lookupTable(mapTableSize);
+    auto const scale = (hi != lo ? 1.0f / (hi - lo) : 0.0f);
+
+    auto const convert = [](quint16 v){ return static_cast<float>(v); };
+    mapConverted(lut, values, n, convert, lo, scale, 0, out);
+}
+
+//-----------------------------------------------------------------------------
+QImage qtGradient::renderImage(
+    QSize size, Qt::Orientation orientation, QImage::Format format) const
+{
+    if (size.isEmpty())
+        return {};
+
+    QImage image{size, QImage::Format_ARGB32};
+    auto* const bits = image.bits();
+    auto const stride = image.bytesPerLine();
+    auto const width = size.width();
+
+    if (orientation == Qt::Horizontal)
+    {
+        // Render the first row, then copy it to the remaining rows
+        auto const& lut = this->lookupTable(width);
+        auto const rowBytes = static_cast<size_t>(width) * sizeof(QRgb);
+        std::memcpy(bits, lut.colors(), rowBytes);
+        forEachRow(image, [=](int y){
+            if (y > 0)
+                std::memcpy(bits + (y * stride), bits, rowBytes);
+        });
+    }
+    else
+    {
+        // Fill each row with a single color; the top row is the end of the
+        // gradient, as in a legend
+        auto const height = size.height();
+        auto const& lut = this->lookupTable(height);
+        auto const* const colors = lut.colors();
+        forEachRow(image, [=](int y){
+            auto* const row = reinterpret_cast<QRgb*>(bits + (y * stride));
+            std::fill(row, row + width, colors[height - 1 - y]);
+        });
+    }
+
+    finishImage(image, format);
+    return image;
+}
+
+//-----------------------------------------------------------------------------
+QImage qtGradient::renderImage(
+    float const* values, QSize size, float lo, float hi,
+    QImage::Format format, QRgb nanColor) const
+{
+    if (size.isEmpty())
+        return {};
+
+    // 32-bit scanlines have no padding, so the whole image can be mapped at
+    // once, which also lets map() split the work across threads
+    QImage image{size, QImage::Format_ARGB32};
+    auto* const out = reinterpret_cast<QRgb*>(image.bits());
+    this->map(values, size.width() * size.height(), lo, hi, out, nanColor);
+
+    finishImage(image, format);
+    return image;
+}
+
+//-----------------------------------------------------------------------------
+QImage qtGradient::renderImage(
+    quint16 const* values, QSize size, float lo, float hi,
+    QImage::Format format) const
+{
+    if (size.isEmpty())
+        return {};
+
+    QImage image{size, QImage::Format_ARGB32};
+    auto* const out = reinterpret_cast<QRgb*>(image.bits());
+    this->map(values, size.width() * size.height(), lo, hi, out);
+
+    finishImage(image, format);
+    return image;
+}
+
+//-----------------------------------------------------------------------------
+quint64 qtGradient::contentHash() const
+{
+    QTE_D_SHARED();
+
+    // 64-bit FNV-1a
+    auto hash = quint64{14695981039346656037ull};
+    auto const combine = [&hash](qreal value)
+    {
+        // Normalize negative zero, so that equal values hash equally
+        value += 0.0;
+
+        unsigned char bytes[sizeof(value)];
+        memcpy(bytes, &value, sizeof(value));
+        for (auto const b : bytes)
+            hash = (hash ^ b) * 1099511628211ull;
+    };
+
+    combine(static_cast<int>(d->interpolateMode));
+    combine(static_cast<int>(d->spread));
+    foreach (auto const& stop, d->stops)
+    {
+        combine(stop.position);
+        combine(stop.weight);
+
+        // Hash the color in its own space, since interpolation in a different
+        // space depends on components that do not survive conversion to RGB
+        // (e.g. the hue of a gray color)
+        auto const& color = stop.color;
+        qreal c[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+        switch (color.spec())
+        {
+            case QColor::Cmyk:
+                color.getCmykF(c + 0, c + 1, c + 2, c + 3, c + 4);
+                break;
+            case QColor::Hsv:
+                color.getHsvF(c + 0, c + 1, c + 2, c + 4);
+                break;
+            case QColor::Hsl:
+                color.getHslF(c + 0, c + 1, c + 2, c + 4);
+                break;
+            default:
+                color.getRgbF(c + 0, c + 1, c + 2, c + 4);
+                break;
+        }
+
+        combine(static_cast<int>(color.spec()));
+        for (auto const k : c)
+            combine(k);
+    }
+
+    return hash;
 }
 
 //END qtGradient
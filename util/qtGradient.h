@@ -6,8 +6,12 @@
 #define __qtGradient_h
 
 #include <QGradient>
+#include <QImage>
 #include <QMap>
 #include <QSharedDataPointer>
+#include <QVector>
+
+#include <cmath>
 
 #include "../core/qtGlobal.h"
 
@@ -51,6 +55,8 @@ public:
         PadStops
     };
 
+    class LookupTable;
+
     qtGradient();
     qtGradient(QList<Stop> const& stops,
                InterpolationMode = InterpolateLinear,
@@ -77,6 +83,39 @@ public:
     QColor at(qreal) const;
     QList<QColor> render(int size) const;
 
+    // Get a table of colors sampled uniformly across the gradient; sizes less
+    // than 1 are treated as 1
+    LookupTable lookupTable(int size) const;
+
+    // Map scalar values in the range [lo, hi] to colors; values outside the
+    // range are handled according to the spread mode, and NaN values map to
+    // nanColor
+    void map(float const* values, int n, float lo, float hi,
+             QRgb* out, QRgb nanColor = 0) const;
+    void map(double const* values, int n, double lo, double hi,
+             QRgb* out, QRgb nanColor = 0) const;
+    void map(quint16 const* values, int n, float lo, float hi,
+             QRgb* out) const;
+
+    // Render the gradient as an image, with the gradient running along the
+    // specified orientation (left to right, or bottom to top)
+    QImage renderImage(QSize size,
+                       Qt::Orientation orientation = Qt::Horizontal,
+                       QImage::Format format = QImage::Format_ARGB32) const;
+
+    // Render a scalar field (with one value per pixel, in row-major order) as
+    // an image, mapping values to colors as in map()
+    QImage renderImage(float const* values, QSize size, float lo, float hi,
+                       QImage::Format format = QImage::Format_ARGB32,
+                       QRgb nanColor = 0) const;
+    QImage renderImage(quint16 const* values, QSize size, float lo, float hi,
+                       QImage::Format format = QImage::Format_ARGB32) const;
+
+    // Compute a hash of the stops, interpolation mode and spread; gradients
+    // which compare equal in content have the same hash, which makes this
+    // suitable for keying caches of rendered output
+    quint64 contentHash() const;
+
 protected:
     QTE_DECLARE_SHARED_PTR(qtGradient)
 
@@ -86,4 +125,61 @@ private:
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(qtGradient::InterpolationMode)
 
+//-----------------------------------------------------------------------------
+class qtGradient::LookupTable
+{
+public:
+    LookupTable() : spread{QGradient::PadSpread} {}
+
+    int size() const { return rgb.size(); }
+    bool isEmpty() const { return rgb.isEmpty(); }
+
+    // Colors as unpremultiplied ARGB, one per entry
+    QRgb const* colors() const { return rgb.constData(); }
+    // Colors as unpremultiplied floating point RGBA, four values per entry
+    float const* colorsF() const { return rgbaF.constData(); }
+
+    Spread spreadMode() const { return spread; }
+
+    inline int index(qreal pos) const;
+
+    // Look up the entry for a position; an empty (default constructed) table
+    // gives transparent black, or a null pointer for atF()
+    QRgb at(qreal pos) const
+    { return (rgb.isEmpty() ? QRgb{0} : rgb[index(pos)]); }
+    float const* atF(qreal pos) const
+    { return (rgbaF.isEmpty() ? 0 : rgbaF.constData() + (4 * index(pos))); }
+
+protected:
+    friend class qtGradient;
+
+    QVector<QRgb> rgb;
+    QVector<float> rgbaF;
+    Spread spread;
+};
+
+//-----------------------------------------------------------------------------
+int qtGradient::LookupTable::index(qreal pos) const
+{
+    // Apply spread to get normalized position
+    switch (spread)
+    {
+        case QGradient::RepeatSpread:
+            pos -= std::floor(pos);
+            break;
+        case QGradient::ReflectSpread:
+            pos = std::fabs(std::fmod(pos, 2.0));
+            (pos > 1.0) && (pos = 2.0 - pos);
+            break;
+        default:
+            pos = qBound(0.0, pos, 1.0);
+            break;
+    }
+
+    // Written so that NaN maps to the first entry
+    auto const last = rgb.size() - 1;
+    auto const i = (pos * last) + 0.5;
+    return (i > 0.0 ? (i < last ? static_cast<int>(i) : last) : 0);
+}
+
 #endif
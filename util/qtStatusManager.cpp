@@ -9,6 +9,7 @@
 #include <QLabel>
 #include <QList>
 #include <QProgressBar>
+#include <QTimer>
 
 #include "../core/qtDebug.h"
 
@@ -24,20 +25,35 @@ public:
   struct StatusInfo
     {
     StatusInfo()
-      : progressAvailable(false), progressMinimum(0), progressMaximum(0),
-        progressValue(-1)
+      : progressAvailable(false), progressAggregate(false),
+        progressMinimum(0), progressMaximum(0), progressValue(-1)
       {}
 
     QString text;
     bool progressAvailable;
+    bool progressAggregate;
     int progressMinimum;
     int progressMaximum;
     int progressValue;
     QString progressFormat;
     };
 
+  // Node of the most-recently-active sender list; nodes are linked directly
+  // to each other (so reordering does not touch the container) and indexed
+  // by owner (so lookup does not require a scan)
+  struct SenderNode
+    {
+    SenderNode(const qtStatusSource& s) : source(s), prev(0), next(0) {}
+
+    qtStatusSource source;
+    SenderNode* prev;
+    SenderNode* next;
+    };
+
   qtStatusManagerPrivate(qtStatusManager* q)
-    : q_ptr(q), debugArea(qtDebug::InvalidArea) {}
+    : q_ptr(q), debugArea(qtDebug::InvalidArea),
+      firstSender(0), lastSender(0) {}
+  ~qtStatusManagerPrivate() { qDeleteAll(this->senders); }
 
   void setLastSender(qtStatusSource&);
   void removeSendersByObject(const QObject*);
@@ -46,14 +62,21 @@ public:
 protected:
   QTE_DECLARE_PUBLIC_PTR(qtStatusManager)
 
+  void linkSender(SenderNode*);
+  void unlinkSender(SenderNode*);
+
   qtDebugAreaAccessor debugArea;
 
   QList<QLabel*> labels;
   QList<QProgressBar*>progressBars;
 
-  QList<qtStatusSource> senders;
+  QHash<const QObject*, SenderNode*> senders;
+  SenderNode* firstSender;
+  SenderNode* lastSender;
   QHash<const QObject*, StatusInfo> status;
 
+  QTimer aggregateProgressTimer;
+
 private:
   QTE_DECLARE_PUBLIC(qtStatusManager)
 };
@@ -64,6 +87,7 @@ QDebug& operator<<(QDebug& dbg, qtStatusManagerPrivate::StatusInfo si)
   dbg.nospace();
   dbg << "( text = " << si.text
       << ", progressAvailable = " << si.progressAvailable
+      << ", progressAggregate = " << si.progressAggregate
       << ", progressMinimum = " << si.progressMinimum
       << ", progressMaximum = " << si.progressMaximum
       << ", progressValue = " << si.progressValue
@@ -72,6 +96,23 @@ QDebug& operator<<(QDebug& dbg, qtStatusManagerPrivate::StatusInfo si)
   return dbg.space();
 }
 
+//-----------------------------------------------------------------------------
+void qtStatusManagerPrivate::linkSender(SenderNode* node)
+{
+  node->prev = this->lastSender;
+  node->next = 0;
+  (this->lastSender ? this->lastSender->next : this->firstSender) = node;
+  this->lastSender = node;
+}
+
+//-----------------------------------------------------------------------------
+void qtStatusManagerPrivate::unlinkSender(SenderNode* node)
+{
+  (node->prev ? node->prev->next : this->firstSender) = node->next;
+  (node->next ? node->next->prev : this->lastSender) = node->prev;
+  node->prev = node->next = 0;
+}
+
 //-----------------------------------------------------------------------------
 void qtStatusManagerPrivate::setLastSender(qtStatusSource& source)
 {
@@ -82,8 +123,21 @@ void qtStatusManagerPrivate::setLastSender(qtStatusSource& source)
              q, SLOT(removeSource(qtStatusSource)), Qt::UniqueConnection);
 
   // Move sender to top of the list, if not already there
-  this->senders.removeAll(source);
-  this->senders.append(source);
+  SenderNode*& node = this->senders[source.owner()];
+  if (node)
+    {
+    node->source = source;
+    if (node != this->lastSender)
+      {
+      this->unlinkSender(node);
+      this->linkSender(node);
+      }
+    }
+  else
+    {
+    node = new SenderNode(source);
+    this->linkSender(node);
+    }
 
   // Check if the sender was deleted while we were adding it
   if (source.isOwnerDestroyed())
@@ -95,17 +149,10 @@ void qtStatusManagerPrivate::setLastSender(qtStatusSource& source)
 //-----------------------------------------------------------------------------
 void qtStatusManagerPrivate::removeSendersByObject(const QObject* obj)
 {
-  QList<qtStatusSource>::iterator iter = this->senders.begin();
-  while (iter != this->senders.end())
+  if (SenderNode* const node = this->senders.take(obj))
     {
-    if (iter->owner() == obj)
-      {
-      iter = this->senders.erase(iter);
-      }
-    else
-      {
-      ++iter;
-      }
+    this->unlinkSender(node);
+    delete node;
     }
 }
 
@@ -114,12 +161,17 @@ void qtStatusManagerPrivate::update()
 {
   StatusInfo si;
 
-  if (!this->senders.isEmpty())
+  if (this->lastSender)
     {
-    si = this->status[this->senders.last().owner()];
+    si = this->status[this->lastSender->source.owner()];
+    if (si.progressAggregate)
+      {
+      si.progressValue =
+        qRound(this->lastSender->source.progress() * si.progressMaximum);
+      }
 
     qtDebug(this->debugArea)
-        << "updating status using sender" << this->senders.last()
+        << "updating status using sender" << this->lastSender->source
         << "status" << si;
     }
   else
@@ -127,6 +179,19 @@ void qtStatusManagerPrivate::update()
     qtDebug(this->debugArea) << "clearing status";
     }
 
+  // Poll aggregate progress only while it is being displayed
+  if (si.progressAvailable && si.progressAggregate)
+    {
+    if (!this->aggregateProgressTimer.isActive())
+      {
+      this->aggregateProgressTimer.start();
+      }
+    }
+  else
+    {
+    this->aggregateProgressTimer.stop();
+    }
+
   foreach (auto const label, this->labels)
     label->setText(si.text);
 
@@ -157,6 +222,11 @@ qtStatusManager::qtStatusManager(QObject* parent)
   : QObject(parent), d_ptr(new qtStatusManagerPrivate(this))
 {
   qRegisterMetaType<qtStatusSource>("qtStatusSource");
+
+  QTE_D(qtStatusManager);
+  d->aggregateProgressTimer.setInterval(100);
+  connect(&d->aggregateProgressTimer, SIGNAL(timeout()),
+          this, SLOT(pollAggregateProgress()));
 }
 
 //-----------------------------------------------------------------------------
@@ -236,9 +306,10 @@ void qtStatusManager::removeSource(qtStatusSource source)
   // Clear this object's status
   if (d->status.contains(source.owner()))
     {
-    bool needUpdate = (d->senders.last() == source);
+    bool needUpdate =
+      (d->lastSender && d->lastSender->source == source);
     d->status.remove(source.owner());
-    d->senders.removeAll(source);
+    d->removeSendersByObject(source.owner());
     if (needUpdate)
       {
       d->update();
@@ -274,7 +345,7 @@ void qtStatusManager::setStatusText(qtStatusSource source, QString text)
   if (text.isEmpty())
     {
     // No text means we should clear this sender's status
-    d->senders.removeAll(source);
+    d->removeSendersByObject(source.owner());
     d->status.remove(source.owner());
     }
   else
@@ -317,6 +388,7 @@ void qtStatusManager::setProgress(qtStatusSource source, bool available,
 
   qtStatusManagerPrivate::StatusInfo& si = d->status[source.owner()];
   si.progressAvailable = available;
+  si.progressAggregate = false;
   si.progressMinimum = minimum;
   si.progressMaximum = maximum;
   si.progressValue = value;
@@ -325,3 +397,31 @@ void qtStatusManager::setProgress(qtStatusSource source, bool available,
   d->setLastSender(source);
   d->update();
 }
+
+//-----------------------------------------------------------------------------
+void qtStatusManager::setAggregateProgress(qtStatusSource source,
+                                           QString format)
+{
+  QTE_D(qtStatusManager);
+
+  qtDebug(d->debugArea)
+      << "setting aggregate progress" << source
+      << "( format =" << format << ')';
+
+  qtStatusManagerPrivate::StatusInfo& si = d->status[source.owner()];
+  si.progressAvailable = true;
+  si.progressAggregate = true;
+  si.progressMinimum = 0;
+  si.progressMaximum = 10000;
+  si.progressFormat = format;
+
+  d->setLastSender(source);
+  d->update();
+}
+
+//-----------------------------------------------------------------------------
+void qtStatusManager::pollAggregateProgress()
+{
+  QTE_D(qtStatusManager);
+  d->update();
+}
@@ -44,9 +44,19 @@ public slots:
   void setProgress(qtStatusSource source, bool available, int value,
                    int minimum, int maximum, QString format = "%p%");
 
+  /// Display the aggregate progress of a source's progress tree.
+  ///
+  /// This sets the progress of \p source to be the aggregate progress of its
+  /// progress tree (see qtStatusSource::createChild). Rather than requiring
+  /// notifications of every progress change, the manager periodically polls
+  /// the aggregate value while the source's status is displayed.
+  void setAggregateProgress(qtStatusSource source,
+                            QString format = "%p%");
+
 protected slots:
   void removeObject(QObject*);
   void removeSource(qtStatusSource);
+  void pollAggregateProgress();
 
 protected:
   QTE_DECLARE_PRIVATE_RPTR(qtStatusManager)
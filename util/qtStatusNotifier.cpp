@@ -37,6 +37,8 @@ void qtStatusNotifier::addReceiver(qtStatusManager* manager) const
           manager, SLOT(setProgress(qtStatusSource, bool, qreal)));
   connect(this, SIGNAL(progressAvailable(qtStatusSource, bool, int, int)),
           manager, SLOT(setProgress(qtStatusSource, bool, int, int)));
+  connect(this, SIGNAL(aggregateProgressAvailable(qtStatusSource)),
+          manager, SLOT(setAggregateProgress(qtStatusSource)));
 }
 
 //-----------------------------------------------------------------------------
@@ -72,6 +74,13 @@ void qtStatusNotifier::postStatus(QString message, int progressValue,
                                progressValue, progressSteps);
 }
 
+//-----------------------------------------------------------------------------
+void qtStatusNotifier::postAggregateStatus(QString message)
+{
+  emit this->statusMessageAvailable(this->statusSource(), message);
+  emit this->aggregateProgressAvailable(this->statusSource());
+}
+
 //-----------------------------------------------------------------------------
 void qtStatusNotifier::clearStatus()
 {
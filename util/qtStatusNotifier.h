@@ -27,6 +27,7 @@ signals:
   void statusMessageAvailable(qtStatusSource, QString = QString());
   void progressAvailable(qtStatusSource, bool = false, qreal value = -1);
   void progressAvailable(qtStatusSource, bool, int value, int steps);
+  void aggregateProgressAvailable(qtStatusSource);
 
 protected:
   QTE_DECLARE_PRIVATE_RPTR(qtStatusNotifier)
@@ -37,6 +38,14 @@ protected:
   void postStatus(QString message, qreal progress);
   void postStatus(QString message, int progressValue, int progressSteps);
 
+  /// Post status, with progress taken from this notifier's progress tree.
+  ///
+  /// This posts a status message, and requests that receivers display the
+  /// aggregate progress of this notifier's status source (see
+  /// qtStatusSource::createChild). Subsequent progress changes are picked up
+  /// by the receivers without further notifications.
+  void postAggregateStatus(QString message);
+
   void clearStatus();
 
 private:
@@ -10,7 +10,9 @@ QTE_IMPLEMENT_D_FUNC(qtStatusSource)
 
 //-----------------------------------------------------------------------------
 qtStatusSourcePrivate::qtStatusSourcePrivate(QObject* obj)
-  : owner(obj), ownerRef(obj)
+  : owner(obj), ownerRef(obj), weight(0),
+    progressCompleted(0), progressTotal(0),
+    childWeight(0), childProgress(0), progress(0)
 {
   if (obj)
     {
@@ -29,6 +31,57 @@ void qtStatusSourcePrivate::ownerDestroyed()
   emit this->ownerDestroyed({this});
 }
 
+//-----------------------------------------------------------------------------
+qint64 qtStatusSourcePrivate::computeProgress() const
+{
+  auto numerator = this->childProgress.loadAcquire();
+  auto denominator = this->childWeight.loadAcquire();
+
+  // The source's own counters contribute as if they were a child of unit
+  // weight, but only once a total has been given
+  auto const total = this->progressTotal.loadAcquire();
+  if (total > 0)
+    {
+    auto const completed =
+      qBound(qint64(0), this->progressCompleted.loadAcquire(), total);
+    numerator += (completed * ProgressScale) / total;
+    ++denominator;
+    }
+
+  return (denominator > 0 ? numerator / denominator : 0);
+}
+
+//-----------------------------------------------------------------------------
+void qtStatusSourcePrivate::updateProgress()
+{
+  auto* node = this;
+  while (node)
+    {
+    auto changed = false;
+    while (true)
+      {
+      // Publish the node's progress, and pass the change on to the parent
+      auto const current = node->computeProgress();
+      auto const previous = node->progress.fetchAndStoreOrdered(current);
+      if (current != previous && node->parent)
+        {
+        auto const delta = (current - previous) * node->weight;
+        node->parent->childProgress.fetchAndAddOrdered(delta);
+        changed = true;
+        }
+
+      // If another thread changed the inputs while we were publishing, we
+      // may have overwritten a newer value with an older one; try again
+      if (node->computeProgress() == current)
+        {
+        break;
+        }
+      }
+
+    node = (changed ? node->parent.data() : 0);
+    }
+}
+
 //-----------------------------------------------------------------------------
 qtStatusSource::qtStatusSource(QObject* owner)
   : d_ptr(new qtStatusSourcePrivate(owner))
@@ -73,6 +126,51 @@ void qtStatusSource::setName(QObject* obj)
     }
 }
 
+//-----------------------------------------------------------------------------
+qtStatusSource qtStatusSource::createChild(QObject* owner, int weight) const
+{
+  qtStatusSource child(owner);
+  child.d_ptr->parent = this->d_ptr;
+  child.d_ptr->weight = qMax(0, weight);
+
+  this->d_ptr->childWeight.fetchAndAddOrdered(child.d_ptr->weight);
+  this->d_ptr->updateProgress();
+
+  return child;
+}
+
+//-----------------------------------------------------------------------------
+void qtStatusSource::setProgressTotal(qint64 total)
+{
+  QTE_D(qtStatusSource);
+  d->progressTotal.storeRelease(total);
+  d->updateProgress();
+}
+
+//-----------------------------------------------------------------------------
+void qtStatusSource::setProgressCompleted(qint64 completed)
+{
+  QTE_D(qtStatusSource);
+  d->progressCompleted.storeRelease(completed);
+  d->updateProgress();
+}
+
+//-----------------------------------------------------------------------------
+void qtStatusSource::addProgressCompleted(qint64 count)
+{
+  QTE_D(qtStatusSource);
+  d->progressCompleted.fetchAndAddOrdered(count);
+  d->updateProgress();
+}
+
+//-----------------------------------------------------------------------------
+qreal qtStatusSource::progress() const
+{
+  QTE_D_CONST(qtStatusSource);
+  return static_cast<qreal>(d->progress.loadAcquire()) /
+         static_cast<qreal>(qtStatusSourcePrivate::ProgressScale);
+}
+
 //-----------------------------------------------------------------------------
 qtStatusSource& qtStatusSource::operator=(const qtStatusSource& other)
 {
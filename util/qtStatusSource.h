@@ -24,6 +24,33 @@ public:
 
   void setName(QObject*);
 
+  /// Create a child source in this source's progress tree.
+  ///
+  /// This creates a new source whose progress contributes to the progress of
+  /// this source. The aggregate progress of a source is the weighted average
+  /// of the progress of its children, plus its own counters (see
+  /// #setProgressTotal), which count as a child of unit weight once a
+  /// non-zero total has been given.
+  ///
+  /// Progress is rolled up to the root of the tree without locking or
+  /// signals, so it is safe to update the progress of sources in the tree
+  /// from any thread. When the last reference to a child source is released,
+  /// the child's contribution to the progress of its parent remains at its
+  /// final value, so that the aggregate progress never moves backwards.
+  qtStatusSource createChild(QObject* owner, int weight = 1) const;
+
+  /// Set the number of work units of this source.
+  void setProgressTotal(qint64 total);
+  /// Set the number of completed work units of this source.
+  void setProgressCompleted(qint64 completed);
+  /// Increment the number of completed work units of this source.
+  void addProgressCompleted(qint64 count = 1);
+
+  /// Get aggregate progress of this source and its children.
+  ///
+  /// \return Completion fraction, in the range [0, 1].
+  qreal progress() const;
+
   qtStatusSource& operator=(const qtStatusSource& other);
 
   bool operator==(const qtStatusSource& other) const;
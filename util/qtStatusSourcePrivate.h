@@ -6,8 +6,10 @@
 
 #include "qtEnableSharedFromThis.h"
 
+#include <QAtomicInteger>
 #include <QObject>
 #include <QPointer>
+#include <QSharedPointer>
 
 class qtStatusSourcePrivate
     : public qtEnableSharedFromThis<qtStatusSourcePrivate, QObject>
@@ -17,6 +19,12 @@ class qtStatusSourcePrivate
 public:
   qtStatusSourcePrivate(QObject* owner);
 
+  /// Fixed-point scale of aggregated progress values.
+  static constexpr qint64 ProgressScale = 1 << 20;
+
+  qint64 computeProgress() const;
+  void updateProgress();
+
 signals:
   void ownerDestroyed(qtStatusSource);
 
@@ -33,4 +41,15 @@ private:
   QPointer<QObject> ownerRef;
   QString ownerIdentifier;
   QString displayIdentifier;
+
+  // Progress tree; all counters are updated without locking, so that worker
+  // threads can report progress without contention
+  QSharedPointer<qtStatusSourcePrivate> parent;
+  int weight;
+
+  QAtomicInteger<qint64> progressCompleted;
+  QAtomicInteger<qint64> progressTotal;
+  QAtomicInteger<qint64> childWeight;
+  QAtomicInteger<qint64> childProgress;
+  QAtomicInteger<qint64> progress;
 };
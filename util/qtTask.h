@@ -0,0 +1,497 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#ifndef __qtTask_h
+#define __qtTask_h
+
+/// \file
+
+#include "../core/qtGlobal.h"
+#include "../core/qtThreadPool.h"
+
+#include "qtProcess.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QHash>
+#include <QObject>
+#include <QSharedPointer>
+#include <QTimerEvent>
+
+#ifndef __cpp_impl_coroutine
+#  error qtTask requires C++20 coroutine support (QTE_ENABLE_COROUTINES)
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+template <typename T = void> class qtTask;
+
+namespace qtTaskDetail
+{
+
+/// \cond internal
+
+//-----------------------------------------------------------------------------
+// Per-thread object used to resume coroutines in the thread's event loop
+class Resumer : public QObject
+{
+public:
+  static Resumer* current()
+  {
+    thread_local Resumer instance;
+    return &instance;
+  }
+
+  // Schedule resumption; may be called from any thread
+  void post(std::coroutine_handle<> handle)
+  {
+    QCoreApplication::postEvent(this, new ResumeEvent{handle});
+  }
+
+  // Schedule resumption after a delay; must be called from the owning thread
+  void postDelayed(std::coroutine_handle<> handle, int msec)
+  {
+    this->timers.insert(this->startTimer(msec), handle);
+  }
+
+protected:
+  class ResumeEvent : public QEvent
+  {
+  public:
+    static QEvent::Type type()
+    {
+      static auto const t =
+        static_cast<QEvent::Type>(QEvent::registerEventType());
+      return t;
+    }
+
+    explicit ResumeEvent(std::coroutine_handle<> h)
+      : QEvent{type()}, handle{h} {}
+
+    std::coroutine_handle<> const handle;
+  };
+
+  bool event(QEvent* e) override
+  {
+    if (e->type() == ResumeEvent::type())
+    {
+      static_cast<ResumeEvent*>(e)->handle.resume();
+      return true;
+    }
+    return QObject::event(e);
+  }
+
+  void timerEvent(QTimerEvent* e) override
+  {
+    this->killTimer(e->timerId());
+    auto const handle = this->timers.take(e->timerId());
+    if (handle)
+      handle.resume();
+  }
+
+  QHash<int, std::coroutine_handle<>> timers;
+};
+
+//-----------------------------------------------------------------------------
+struct PromiseBase
+{
+  struct FinalAwaiter
+  {
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<Promise> handle) noexcept
+    {
+      auto& promise = handle.promise();
+      auto const continuation = promise.continuation;
+
+      // If nothing holds the task any more, the frame is ours to clean up
+      if (promise.detached)
+        handle.destroy();
+
+      return (continuation ? continuation : std::noop_coroutine());
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_never initial_suspend() const noexcept { return {}; }
+  FinalAwaiter final_suspend() const noexcept { return {}; }
+
+  void unhandled_exception() { this->exception = std::current_exception(); }
+
+  void rethrow() const
+  {
+    if (this->exception)
+      std::rethrow_exception(this->exception);
+  }
+
+  std::coroutine_handle<> continuation;
+  std::exception_ptr exception;
+  bool detached = false;
+};
+
+//-----------------------------------------------------------------------------
+template <typename T>
+struct Promise : PromiseBase
+{
+  qtTask<T> get_return_object();
+
+  template <typename U>
+  void return_value(U&& value) { this->result.emplace(std::forward<U>(value)); }
+
+  T take()
+  {
+    this->rethrow();
+    return std::move(*this->result);
+  }
+
+  std::optional<T> result;
+};
+
+//-----------------------------------------------------------------------------
+template <>
+struct Promise<void> : PromiseBase
+{
+  qtTask<void> get_return_object();
+
+  void return_void() {}
+
+  void take() { this->rethrow(); }
+};
+
+//-----------------------------------------------------------------------------
+// Result of awaiting a signal; void, a single value, or a tuple
+template <typename... Args>
+struct SignalResult
+{
+  using type = std::tuple<std::decay_t<Args>...>;
+  static type get(type&& values) { return std::move(values); }
+};
+
+template <typename Arg>
+struct SignalResult<Arg>
+{
+  using type = std::decay_t<Arg>;
+  static type get(std::tuple<type>&& values)
+  { return std::get<0>(std::move(values)); }
+};
+
+template <>
+struct SignalResult<>
+{
+  using type = void;
+  static void get(std::tuple<>&&) {}
+};
+
+/// \endcond
+
+} // namespace qtTaskDetail
+
+//-----------------------------------------------------------------------------
+/// Asynchronous task implemented as a coroutine.
+///
+/// qtTask is the return type of coroutines that perform multi-step
+/// asynchronous work. A coroutine returning qtTask starts executing
+/// immediately when called, and runs until it first suspends (via
+/// <code>co_await</code>). It is resumed in the event loop of the thread in
+/// which it was suspended, so that all of the coroutine's code executes in
+/// the same thread, and may safely access objects belonging to that thread.
+///
+/// A qtTask may itself be awaited from another coroutine, in which case the
+/// awaiting coroutine is resumed when the task completes, and receives the
+/// task's result (or exception). If the qtTask is destroyed before the
+/// coroutine completes, the coroutine keeps running, and its result is
+/// discarded.
+///
+/// \par Example:
+/// \code{.cpp}
+/// qtTask<> Importer::run(QString path)
+/// {
+///     qtProcess process;
+///     process.start("convert", {path, this->tempPath});
+///     if (co_await qtAwaitProcess(&process) != 0)
+///         co_return;
+///
+///     auto data = co_await qtAwaitPool([this]{ return this->load(); });
+///     co_await qtAwaitTimeout(100);
+///     emit this->imported(data);
+/// }
+/// \endcode
+///
+/// \note
+///   qtTask requires C++20, and is only available when qtExtensions is built
+///   with \c QTE_ENABLE_COROUTINES.
+template <typename T>
+class qtTask
+{
+public:
+  using promise_type = qtTaskDetail::Promise<T>;
+  using Handle = std::coroutine_handle<promise_type>;
+
+  qtTask(qtTask&& other) noexcept : handle{std::exchange(other.handle, {})} {}
+
+  ~qtTask()
+  {
+    if (this->handle)
+    {
+      if (this->handle.done())
+        this->handle.destroy();
+      else
+        this->handle.promise().detached = true;
+    }
+  }
+
+  qtTask& operator=(qtTask&&) = delete;
+
+  /// Test if the task has completed.
+  bool isFinished() const { return !this->handle || this->handle.done(); }
+
+  /// \cond internal
+  bool await_ready() const noexcept { return this->handle.done(); }
+
+  void await_suspend(std::coroutine_handle<> awaiter) noexcept
+  { this->handle.promise().continuation = awaiter; }
+
+  T await_resume() { return this->handle.promise().take(); }
+  /// \endcond
+
+protected:
+  friend promise_type;
+
+  explicit qtTask(Handle h) : handle{h} {}
+
+  QTE_DISABLE_COPY(qtTask)
+
+  Handle handle;
+};
+
+//-----------------------------------------------------------------------------
+template <typename T>
+qtTask<T> qtTaskDetail::Promise<T>::get_return_object()
+{
+  return qtTask<T>{qtTask<T>::Handle::from_promise(*this)};
+}
+
+//-----------------------------------------------------------------------------
+inline qtTask<void> qtTaskDetail::Promise<void>::get_return_object()
+{
+  return qtTask<void>{qtTask<void>::Handle::from_promise(*this)};
+}
+
+//-----------------------------------------------------------------------------
+/// Awaitable for the emission of a signal.
+///
+/// \sa qtAwaitSignal
+template <typename Sender, typename... Args>
+class qtSignalAwaiter
+{
+public:
+  using Signal = void (Sender::*)(Args...);
+  using Result = qtTaskDetail::SignalResult<Args...>;
+
+  qtSignalAwaiter(Sender* sender, Signal signal)
+    : sender{sender}, signal{signal}, state{new State} {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> handle)
+  {
+    auto* const resumer = qtTaskDetail::Resumer::current();
+
+    // Use a direct connection so that no metatype registration is needed for
+    // the arguments; the arguments are copied, and the coroutine is resumed
+    // in its own thread via the resumer. The signal may be emitted from
+    // another thread, even before connect() returns, or again after the
+    // coroutine has resumed (and destroyed the awaiter), so the slot only
+    // touches the shared state, and only the first emission is used; the
+    // connection is only accessed from the coroutine's thread.
+    auto const state = this->state;
+    this->state->connection = QObject::connect(
+      this->sender, this->signal, resumer,
+      [state, handle, resumer](Args... args) {
+        if (state->fired.exchange(true))
+          return;
+        state->values.emplace(args...);
+        resumer->post(handle);
+      }, Qt::DirectConnection);
+  }
+
+  typename Result::type await_resume()
+  {
+    QObject::disconnect(this->state->connection);
+    return Result::get(std::move(*this->state->values));
+  }
+
+protected:
+  struct State
+  {
+    QMetaObject::Connection connection;
+    std::atomic<bool> fired{false};
+    std::optional<std::tuple<std::decay_t<Args>...>> values;
+  };
+
+  Sender* const sender;
+  Signal const signal;
+
+  QSharedPointer<State> const state;
+};
+
+/// Suspend the calling coroutine until \p sender emits \p signal.
+///
+/// The result of the <code>co_await</code> expression is the signal's
+/// argument (if the signal has one argument), a \c std::tuple of the signal's
+/// arguments (if the signal has more than one argument), or \c void.
+///
+/// \warning
+///   If \p sender is destroyed without emitting \p signal, the coroutine is
+///   never resumed.
+template <typename Sender, typename Base, typename... Args>
+qtSignalAwaiter<Base, Args...> qtAwaitSignal(
+  Sender* sender, void (Base::*signal)(Args...))
+{
+  return {sender, signal};
+}
+
+//-----------------------------------------------------------------------------
+/// Awaitable for the completion of a process.
+///
+/// \sa qtAwaitProcess
+class qtProcessAwaiter
+  : public qtSignalAwaiter<QProcess, int, QProcess::ExitStatus>
+{
+public:
+  explicit qtProcessAwaiter(qtProcess* process)
+    : qtSignalAwaiter{process, &QProcess::finished} {}
+
+  bool await_ready() const
+  { return this->sender->state() == QProcess::NotRunning; }
+
+  int await_resume()
+  {
+    QObject::disconnect(this->state->connection);
+    if (!this->state->values)
+      return this->sender->exitCode();
+    return std::get<0>(*this->state->values);
+  }
+};
+
+/// Suspend the calling coroutine until \p process finishes.
+///
+/// The result of the <code>co_await</code> expression is the exit code of the
+/// process. If the process is not running, the coroutine is not suspended.
+inline qtProcessAwaiter qtAwaitProcess(qtProcess* process)
+{
+  return qtProcessAwaiter{process};
+}
+
+//-----------------------------------------------------------------------------
+/// Awaitable for the execution of a function on a thread pool.
+///
+/// \sa qtAwaitPool
+template <typename Function>
+class qtPoolAwaiter
+{
+public:
+  using Result = std::invoke_result_t<Function>;
+
+  qtPoolAwaiter(Function function, qtThreadPool* pool,
+                qtThreadPool::Priority priority)
+    : function{std::move(function)}, pool{pool}, priority{priority} {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> handle)
+  {
+    auto* const resumer = qtTaskDetail::Resumer::current();
+    this->pool->post(
+      [this, handle, resumer]{
+        try
+        {
+          if constexpr (std::is_void_v<Result>)
+            this->function();
+          else
+            this->result.emplace(this->function());
+        }
+        catch (...)
+        {
+          this->exception = std::current_exception();
+        }
+        resumer->post(handle);
+      }, this->priority);
+  }
+
+  Result await_resume()
+  {
+    if (this->exception)
+      std::rethrow_exception(this->exception);
+    if constexpr (!std::is_void_v<Result>)
+      return std::move(*this->result);
+  }
+
+protected:
+  struct Empty {};
+  using Storage = std::conditional_t<std::is_void_v<Result>, Empty, Result>;
+
+  Function function;
+  qtThreadPool* const pool;
+  qtThreadPool::Priority const priority;
+
+  std::optional<Storage> result;
+  std::exception_ptr exception;
+};
+
+/// Execute \p function on a thread pool, and resume with its result.
+///
+/// This suspends the calling coroutine, executes \p function on a worker of
+/// \p pool (or the global thread pool, if \p pool is null), and then resumes
+/// the coroutine in its own thread. The result of the <code>co_await</code>
+/// expression is the result of \p function. If \p function throws, the
+/// exception is rethrown in the coroutine.
+template <typename Function>
+qtPoolAwaiter<std::decay_t<Function>> qtAwaitPool(
+  Function&& function, qtThreadPool* pool = nullptr,
+  qtThreadPool::Priority priority = qtThreadPool::NormalPriority)
+{
+  return {std::forward<Function>(function),
+          pool ? pool : qtThreadPool::globalInstance(), priority};
+}
+
+//-----------------------------------------------------------------------------
+/// Awaitable for the expiration of a timeout.
+///
+/// \sa qtAwaitTimeout
+class qtTimeoutAwaiter
+{
+public:
+  explicit qtTimeoutAwaiter(int msec) : msec{msec} {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> handle)
+  { qtTaskDetail::Resumer::current()->postDelayed(handle, this->msec); }
+
+  void await_resume() const noexcept {}
+
+protected:
+  int const msec;
+};
+
+/// Suspend the calling coroutine for \p msec milliseconds.
+///
+/// A timeout of zero resumes the coroutine the next time its thread's event
+/// loop processes events, which can be used to yield to other work.
+inline qtTimeoutAwaiter qtAwaitTimeout(int msec)
+{
+  return qtTimeoutAwaiter{msec};
+}
+
+#endif
@@ -228,7 +228,16 @@ void qtDrawer::addWidget(QWidget* widget, int col)
       {
       d->containerLayout->removeWidget(d->contentWidgets.value(col));
       }
-    d->containerLayout->addWidget(widget, d->row, col);
+    if (d->container->isUpdating())
+      {
+      // Row is not yet known; widget will be added to the layout when the
+      // update ends
+      widget->setParent(d->container);
+      }
+    else
+      {
+      d->containerLayout->addWidget(widget, d->row, col);
+      }
     }
 
   d->contentWidgets.insert(col, widget);
@@ -278,6 +287,14 @@ void qtDrawer::addChild(qtDrawer* child, qtDrawer* before)
   // Determine insertion point
   int row;
   int index = (before ? d->children.indexOf(before) : -1);
+  if (d->container->isUpdating())
+    {
+    // Defer row assignment until the update ends
+    child->setParent(d->container);
+    d->children.insert((index >= 0 ? index : d->children.count()), child);
+    return;
+    }
+
   if (index >= 0)
     {
     // Add at 'before's row, shifting children down
@@ -318,8 +335,12 @@ void qtDrawer::removeChild(qtDrawer* child)
     return;
     }
 
-  // Shift later siblings and remove child
-  this->shiftChildrenUp(child);
+  // Shift later siblings and remove child; if updating, rows are reassigned
+  // when the update ends
+  if (!d->container->isUpdating())
+    {
+    this->shiftChildrenUp(child);
+    }
   d->children.removeAt(index);
 
   // Remove expander if no longer needed
@@ -341,6 +362,30 @@ int qtDrawer::countDescendants() const
   return count;
 }
 
+//-----------------------------------------------------------------------------
+void qtDrawer::assignRows(int& nextRow)
+{
+  QTE_D(qtDrawer);
+
+  foreach (auto const child, d->children)
+    {
+    qtDrawerPrivate* cd = child->d_func();
+    cd->row = nextRow++;
+
+    d->containerLayout->addWidget(child, cd->row, 0);
+    foreach (auto const col, cd->contentWidgets.keys())
+      {
+      if (col != 0)
+        {
+        QWidget* widget = cd->contentWidgets.value(col);
+        d->containerLayout->addWidget(widget, cd->row, col);
+        }
+      }
+
+    child->assignRows(nextRow);
+    }
+}
+
 //-----------------------------------------------------------------------------
 void qtDrawer::shiftChildrenDown(qtDrawer* afterChild)
 {
@@ -56,6 +56,7 @@ protected:
   void setChildVisibility(qtDrawer* child = 0);
 
   int countDescendants() const;
+  void assignRows(int& nextRow);
   void shiftChildrenDown(qtDrawer* afterChild = 0);
   void shiftChildrenUp(qtDrawer* afterChild = 0);
   void shiftDown();
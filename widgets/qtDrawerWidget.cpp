@@ -13,9 +13,12 @@ QTE_IMPLEMENT_D_FUNC(qtDrawerWidget)
 class qtDrawerWidgetPrivate
 {
 public:
-  qtDrawerWidgetPrivate() : root(0) {}
+  qtDrawerWidgetPrivate() : root(0), updateDepth(0), updatesEnabled(true) {}
 
   qtDrawer* root;
+
+  int updateDepth;
+  bool updatesEnabled;
 };
 
 //-----------------------------------------------------------------------------
@@ -48,6 +51,50 @@ void qtDrawerWidget::clear()
   this->root()->clear();
 }
 
+//-----------------------------------------------------------------------------
+void qtDrawerWidget::beginUpdate()
+{
+  QTE_D(qtDrawerWidget);
+
+  if (!d->updateDepth++)
+    {
+    d->updatesEnabled = this->updatesEnabled();
+    this->setUpdatesEnabled(false);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qtDrawerWidget::endUpdate()
+{
+  QTE_D(qtDrawerWidget);
+
+  if (d->updateDepth <= 0 || --d->updateDepth)
+    {
+    return;
+    }
+
+  // Empty the layout; removing drawers individually would cost a search of
+  // the layout for each one
+  QGridLayout* layout = qobject_cast<QGridLayout*>(this->layout());
+  while (QLayoutItem* item = layout->takeAt(layout->count() - 1))
+    {
+    delete item;
+    }
+
+  // Assign rows and repopulate the layout
+  int row = 0;
+  this->root()->assignRows(row);
+
+  this->setUpdatesEnabled(d->updatesEnabled);
+}
+
+//-----------------------------------------------------------------------------
+bool qtDrawerWidget::isUpdating() const
+{
+  QTE_D_CONST(qtDrawerWidget);
+  return d->updateDepth > 0;
+}
+
 //-----------------------------------------------------------------------------
 qtDrawer* qtDrawerWidget::root()
 {
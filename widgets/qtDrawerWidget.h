@@ -23,6 +23,24 @@ public:
   virtual qtDrawer* addDrawer(qtDrawer* nextSibling = 0);
   virtual void clear();
 
+  /// Begin a batch of structural changes.
+  ///
+  /// Normally, each drawer that is added or removed immediately moves every
+  /// later drawer to a new row of the layout. Between calls to beginUpdate()
+  /// and endUpdate(), row assignment is deferred, and updates of the widget
+  /// are disabled; when the outermost endUpdate() is called, the rows of all
+  /// drawers are computed in a single pass, and the layout is rebuilt once.
+  /// Calls may be nested.
+  void beginUpdate();
+
+  /// End a batch of structural changes.
+  ///
+  /// \sa beginUpdate()
+  void endUpdate();
+
+  /// Test if a batch of structural changes is in progress.
+  bool isUpdating() const;
+
 protected:
   QTE_DECLARE_PRIVATE_RPTR(qtDrawerWidget)
 
@@ -12,24 +12,152 @@
 #include <QPaintEvent>
 #include <QPainter>
 #include <QPixmap>
+#include <QPixmapCache>
+
+#include <cstring>
 
 QTE_IMPLEMENT_D_FUNC(qtGradientWidget)
 
+namespace // anonymous
+{
+
+// Size of each check of the background, in device-independent pixels
+int const checkerSize = 6;
+
+//-----------------------------------------------------------------------------
+QRgb composite(float const* color, float const* background)
+{
+  auto const a = color[3];
+  auto const channel = [&](int i){
+    auto const v = background[i] + ((color[i] - background[i]) * a);
+    return qBound(0, static_cast<int>((v * 255.0f) + 0.5f), 255);
+  };
+  return qRgb(channel(0), channel(1), channel(2));
+}
+
+//-----------------------------------------------------------------------------
+void toFloat(QRgb color, float* out)
+{
+  out[0] = static_cast<float>(qRed(color)) / 255.0f;
+  out[1] = static_cast<float>(qGreen(color)) / 255.0f;
+  out[2] = static_cast<float>(qBlue(color)) / 255.0f;
+  out[3] = 1.0f;
+}
+
+} // namespace <anonymous>
+
 //-----------------------------------------------------------------------------
 class qtGradientWidgetPrivate
 {
 public:
+  QString previewKey(QSize size, qreal dpr, QRgb c1, QRgb c2) const;
+  QPixmap renderPreview(QSize size, qreal dpr, QRgb c1, QRgb c2) const;
+
   Qt::Orientation orientation;
   qtGradient gradient;
+  quint64 gradientHash;
+
+  QString pixmapKey;
   QPixmap pixmap;
 };
 
+//-----------------------------------------------------------------------------
+QString qtGradientWidgetPrivate::previewKey(
+  QSize size, qreal dpr, QRgb c1, QRgb c2) const
+{
+  // Only the length along the gradient affects the preview, as the preview
+  // is tiled across the other dimension
+  auto const length =
+    (this->orientation == Qt::Horizontal ? size.width() : size.height());
+
+  return QString("qtGradientWidget:%1:%2:%3:%4:%5:%6")
+    .arg(this->gradientHash, 16, 16, QChar('0'))
+    .arg(this->orientation == Qt::Horizontal ? 'h' : 'v')
+    .arg(length)
+    .arg(dpr)
+    .arg(c1, 8, 16, QChar('0'))
+    .arg(c2, 8, 16, QChar('0'));
+}
+
+//-----------------------------------------------------------------------------
+QPixmap qtGradientWidgetPrivate::renderPreview(
+  QSize size, qreal dpr, QRgb c1, QRgb c2) const
+{
+  auto const horizontal = (this->orientation == Qt::Horizontal);
+
+  // Compute sizes in device pixels; the preview is one gradient length by
+  // two checks
+  auto const check = qMax(1, qRound(checkerSize * dpr));
+  auto const length =
+    qMax(1, qRound((horizontal ? size.width() : size.height()) * dpr));
+  auto const lut = this->gradient.lookupTable(length);
+
+  // Composite the gradient over each of the two background colors; the
+  // gradient runs from left to right, or from bottom to top
+  float bg[2][4];
+  toFloat(c1, bg[0]);
+  toFloat(c2, bg[1]);
+
+  QVector<QRgb> over[2];
+  over[0].resize(length);
+  over[1].resize(length);
+  auto const* const colors = lut.colorsF();
+  foreach (auto const i, qtIndexRange(length))
+    {
+    auto const k = (horizontal ? i : length - i - 1);
+    over[0][k] = composite(colors + (4 * i), bg[0]);
+    over[1][k] = composite(colors + (4 * i), bg[1]);
+    }
+
+  // Write scanlines directly
+  QImage image{horizontal ? QSize(length, 2 * check)
+                          : QSize(2 * check, length),
+               QImage::Format_RGB32};
+  if (horizontal)
+    {
+    // Build the two distinct rows, then copy them to the others
+    foreach (auto const band, qtIndexRange(2))
+      {
+      auto* const line = reinterpret_cast<QRgb*>(image.scanLine(band * check));
+      foreach (auto const i, qtIndexRange(length))
+        {
+        line[i] = over[((i / check) + band + 1) & 1][i];
+        }
+      }
+    auto const bytes = static_cast<size_t>(length) * sizeof(QRgb);
+    foreach (auto const j, qtIndexRange(2 * check))
+      {
+      if (j % check)
+        {
+        memcpy(image.scanLine(j), image.scanLine(j - (j % check)), bytes);
+        }
+      }
+    }
+  else
+    {
+    foreach (auto const j, qtIndexRange(length))
+      {
+      auto* const line = reinterpret_cast<QRgb*>(image.scanLine(j));
+      auto const band = (j / check) + 1;
+      foreach (auto const i, qtIndexRange(2 * check))
+        {
+        line[i] = over[((i / check) + band) & 1][j];
+        }
+      }
+    }
+
+  auto pixmap = QPixmap::fromImage(image);
+  pixmap.setDevicePixelRatio(dpr);
+  return pixmap;
+}
+
 //-----------------------------------------------------------------------------
 qtGradientWidget::qtGradientWidget(QWidget* parent)
   : QWidget(parent), d_ptr(new qtGradientWidgetPrivate)
 {
   QTE_D(qtGradientWidget);
   d->orientation = Qt::Horizontal;
+  d->gradientHash = d->gradient.contentHash();
 }
 
 //-----------------------------------------------------------------------------
@@ -50,7 +178,6 @@ void qtGradientWidget::setOrientation(Qt::Orientation newOrientation)
   QTE_D(qtGradientWidget);
   if (d->orientation != newOrientation)
     {
-    d->pixmap = QPixmap();
     d->orientation = newOrientation;
     this->update();
     }
@@ -68,7 +195,7 @@ void qtGradientWidget::setGradient(qtGradient gradient)
 {
   QTE_D(qtGradientWidget);
   d->gradient = gradient;
-  d->pixmap = QPixmap();
+  d->gradientHash = gradient.contentHash();
   this->update();
 }
 
@@ -93,44 +220,25 @@ void qtGradientWidget::paintEvent(QPaintEvent*)
 {
   QTE_D(qtGradientWidget);
 
-  // Get relevant dimension of pixmap and widget
-  int lastSize, currentSize;
-  if (d->orientation == Qt::Horizontal)
-    {
-    lastSize = d->pixmap.width();
-    currentSize = this->width();
-    }
-  else
-    {
-    lastSize = d->pixmap.height();
-    currentSize = this->height();
-    }
+  auto const& palette = this->palette();
+  auto const c1 = palette.color(QPalette::Window);
+  auto const c2 = qtColorUtil::blend(
+    c1, palette.color(QPalette::WindowText), 0.4);
 
-  // Regenerate pixmap, if needed
-  if (lastSize != currentSize || d->pixmap.isNull())
-    {
-    QImage image(this->width(), 12, QImage::Format_RGB32);
-    QColor c1 = this->palette().color(QPalette::Window);
-    QColor c2 = this->palette().color(QPalette::WindowText);
-    c2 = qtColorUtil::blend(c1, c2, 0.4);
-
-    const int k = this->width();
-    QList<QColor> g = d->gradient.render(k);
+  auto const dpr = this->devicePixelRatioF();
+  auto const size = this->size();
+  auto const key = d->previewKey(size, dpr, c1.rgb(), c2.rgb());
 
-    foreach (auto const i, qtIndexRange(k))
+  // Look for the preview in the shared cache, so that widgets showing the
+  // same gradient at the same size (e.g. while editing) render it only once
+  if (key != d->pixmapKey || d->pixmap.isNull())
+    {
+    if (!QPixmapCache::find(key, &d->pixmap))
       {
-      const QColor& color = g[i];
-      const qreal a = color.alphaF();
-      const QColor cg1 = qtColorUtil::blend(c1, color, a);
-      const QColor cg2 = qtColorUtil::blend(c2, color, a);
-      foreach (auto const j, qtIndexRange(12))
-        {
-        const QColor& cb = (((i % 12) > 5) != ((j % 12) > 5) ? cg1 : cg2);
-        image.setPixel(i, j, cb.rgb());
-        }
+      d->pixmap = d->renderPreview(size, dpr, c1.rgb(), c2.rgb());
+      QPixmapCache::insert(key, d->pixmap);
       }
-
-    d->pixmap = QPixmap::fromImage(image);
+    d->pixmapKey = key;
     }
 
   QPainter painter(this);
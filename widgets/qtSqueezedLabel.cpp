@@ -5,6 +5,7 @@
 #include "qtSqueezedLabel.h"
 
 #include <QApplication>
+#include <QCache>
 #include <QClipboard>
 #include <QFontMetrics>
 #include <QMenu>
@@ -14,11 +15,64 @@
 #include <QStyle>
 #include <QStyleOption>
 #include <QTextDocument>
-
-#include "../core/qtScopedValueChange.h"
+#include <QTextLayout>
 
 QTE_IMPLEMENT_D_FUNC(qtSqueezedLabel)
 
+//BEGIN elision cache
+
+namespace // anonymous
+{
+
+//-----------------------------------------------------------------------------
+struct ElisionKey
+{
+    QString text;
+    QString font;
+    int dpi;
+    int width;
+    int mode;
+
+    bool operator==(ElisionKey const& other) const
+    {
+        return this->width == other.width && this->mode == other.mode &&
+               this->dpi == other.dpi && this->text == other.text &&
+               this->font == other.font;
+    }
+};
+
+//-----------------------------------------------------------------------------
+uint qHash(ElisionKey const& key, uint seed = 0)
+{
+    seed = ::qHash(key.text, seed);
+    seed = ::qHash(key.font, seed);
+    return seed ^ ::qHash((key.width << 4) ^ key.mode) ^ ::qHash(key.dpi);
+}
+
+//-----------------------------------------------------------------------------
+struct ElisionResult
+{
+    int offset;
+    int length;
+    bool elided;
+};
+
+//-----------------------------------------------------------------------------
+// Cache of elision results shared by all labels, so that labels showing the
+// same text at the same width (e.g. in tables) measure the text only once;
+// QCache discards the least recently used entries when full
+QCache<ElisionKey, ElisionResult>& elisionCache()
+{
+    static QCache<ElisionKey, ElisionResult> cache{2048};
+    return cache;
+}
+
+} // namespace <anonymous>
+
+//END elision cache
+
+///////////////////////////////////////////////////////////////////////////////
+
 //BEGIN qtSqueezedLabelPrivate
 
 //-----------------------------------------------------------------------------
@@ -26,17 +80,20 @@ class qtSqueezedLabelPrivate
 {
 public:
     qtSqueezedLabelPrivate()
-    { this->invalidate(nullptr); }
+    { this->invalidate(); }
 
     bool isValid(QString const& text);
 
-    void invalidate(QWidget* self);
-    void recalculate(QSize const&, QFontMetrics const&);
+    void invalidate();
+    void recalculate(QSize const&, QWidget* self);
+    void elide(QFont const&, QFontMetrics const&, QWidget* self,
+               int fullWidth, int availableWidth);
 
     int marginsWidth(QFontMetrics const&) const;
     QRect contentsRect(QRect const&, QFontMetrics const&) const;
 
     QString elidedText(QString const& text) const;
+    QImage const& fadeMask(int width, bool leftAligned);
 
     static QString ellipsis();
 
@@ -44,8 +101,12 @@ public:
     QString fullText;
     qtSqueezedLabel::ElideMode elideMode;
 
-    bool cacheBackground = false;
-    QImage background;
+    // Layer into which faded text is drawn, and the alpha mask that is
+    // applied to it; these are reused while the label size is unchanged
+    QImage textLayer;
+    QImage mask;
+    int maskFadeWidth = -1;
+    bool maskLeftAligned = false;
 
     qreal marginLeft = 0.0;
     qreal marginRight = 0.0;
@@ -62,90 +123,120 @@ bool qtSqueezedLabelPrivate::isValid(QString const& text)
 }
 
 //-----------------------------------------------------------------------------
-void qtSqueezedLabelPrivate::invalidate(QWidget* self)
+void qtSqueezedLabelPrivate::invalidate()
 {
     this->offset = -1;
     this->length = -1;
     this->elided = true;
-
-    if (self)
-    {
-        // Prepare to repaint our underlay background
-        this->background =
-            QImage{self->size(), QImage::Format_ARGB32_Premultiplied};
-        qtScopedValueChange<bool> cb{this->cacheBackground, true};
-
-        // Calculate our rect relative to our top level widget
-        auto* const tlw = self->topLevelWidget();
-        auto rect = self->rect();
-        rect.setTopLeft(self->mapTo(tlw, rect.topLeft()));
-        rect.setBottomRight(self->mapTo(tlw, rect.bottomRight()));
-
-        // Render underlay background
-        tlw->render(&this->background, QPoint{}, rect);
-    }
 }
 
 //-----------------------------------------------------------------------------
-void qtSqueezedLabelPrivate::recalculate(
-    QSize const& size, QFontMetrics const& fm)
+void qtSqueezedLabelPrivate::recalculate(QSize const& size, QWidget* self)
 {
+    auto const& font = self->font();
+    auto const& fm = self->fontMetrics();
+    auto const availableWidth = size.width() - this->marginsWidth(fm);
+    this->fadeWidth = fm.height() * 3;
+
+    // Check for a previously computed result
+    auto const key = ElisionKey{
+        this->cachedText, font.key(), self->logicalDpiX(),
+        availableWidth, static_cast<int>(this->elideMode)};
+    if (auto* const result = elisionCache().object(key))
+    {
+        this->offset = result->offset;
+        this->length = result->length;
+        this->elided = result->elided;
+        return;
+    }
+
     // Check if text fits
     auto const fullWidth = fm.boundingRect(this->cachedText).width();
-    auto const availableWidth = size.width() - this->marginsWidth(fm);
     if (fullWidth <= availableWidth)
     {
         this->length = this->cachedText.length();
         this->offset = 0;
         this->elided = false;
-        return;
     }
-
-    this->elided = true;
-
-    // How are we eliding?
-    if (elideMode.testFlag(qtSqueezedLabel::ElideFade))
+    else
     {
-        this->fadeWidth = fm.height() * 3;
+        this->elided = true;
+        this->elide(font, fm, self, fullWidth, availableWidth);
+    }
+
+    elisionCache().insert(
+        key, new ElisionResult{this->offset, this->length, this->elided});
+}
 
-        // \TODO support modes other then ElideEnd
+//-----------------------------------------------------------------------------
+void qtSqueezedLabelPrivate::elide(
+    QFont const& font, QFontMetrics const& fm, QWidget* self,
+    int fullWidth, int availableWidth)
+{
+    // \TODO support modes other then ElideEnd
+    this->offset = 0;
 
-        // Determine number of characters needed to fill label
-        this->offset = 0;
+    auto const fade = this->elideMode.testFlag(qtSqueezedLabel::ElideFade);
+    auto const& ellipsis = qtSqueezedLabelPrivate::ellipsis();
+    auto const ellipsisWidth = (fade ? 0 : fm.boundingRect(ellipsis).width());
+    if (!fade && availableWidth <= ellipsisWidth)
+    {
+        // Nothing at all fits... will only happen if we are smaller than
+        // our minimumSizeHint(), but deal with it
         this->length = 0;
-        int width = 0;
-        while (width < availableWidth)
+        return;
+    }
+
+    // Lay out the text once; the width of any prefix is then given by the
+    // position of the cursor following the prefix
+    QTextOption option;
+    option.setWrapMode(QTextOption::NoWrap);
+
+    QTextLayout layout{this->cachedText, font, self};
+    layout.setTextOption(option);
+    layout.beginLayout();
+    auto line = layout.createLine();
+    line.setLineWidth(fullWidth);
+    layout.endLayout();
+
+    auto const origin = line.cursorToX(0);
+    auto const prefixWidth = [&](int k){
+        return qAbs(line.cursorToX(k) - origin);
+    };
+
+    auto const n = this->cachedText.length();
+    if (fade)
+    {
+        // Find the fewest characters needed to fill the label
+        auto lo = 1, hi = n;
+        while (lo < hi)
         {
-            ++this->length;
-            auto const& part = this->cachedText.left(this->length);
-            width = fm.boundingRect(part).width();
+            auto const mid = lo + ((hi - lo) / 2);
+            if (prefixWidth(mid) < availableWidth)
+                lo = mid + 1;
+            else
+                hi = mid;
         }
+        while (lo < n && !layout.isValidCursorPosition(lo))
+            ++lo;
+        this->length = lo;
     }
     else
     {
-        // \TODO support modes other then ElideEnd
-        auto const ellipsisWidth =
-            fm.boundingRect(qtSqueezedLabelPrivate::ellipsis()).width();
-        if (availableWidth <= ellipsisWidth)
+        // Find the most characters that fit, leaving room for the ellipsis
+        auto const limit = availableWidth - ellipsisWidth;
+        auto lo = 0, hi = n;
+        while (lo < hi)
         {
-            // Nothing at all fits... will only happen if we are smaller than
-            // our minimumSizeHint(), but deal with it
-            this->length = 0;
-            this->offset = 0;
-            return;
-        }
-
-        // Determine maximum number of characters that can fit
-        this->offset = 0;
-        this->length = this->cachedText.length();
-        auto width = fullWidth + ellipsisWidth;
-        while (this->length > 0 && width > availableWidth)
-        {
-            --this->length;
-            auto const& part = this->cachedText.left(this->length) +
-                               qtSqueezedLabelPrivate::ellipsis();
-            width = fm.boundingRect(part).width();
+            auto const mid = hi - ((hi - lo) / 2);
+            if (prefixWidth(mid) <= limit)
+                lo = mid;
+            else
+                hi = mid - 1;
         }
+        while (lo > 0 && !layout.isValidCursorPosition(lo))
+            --lo;
+        this->length = lo;
     }
 }
 
@@ -161,6 +252,42 @@ QString qtSqueezedLabelPrivate::elidedText(QString const& text) const
         return text.mid(this->offset, this->length) + this->ellipsis();
 }
 
+//-----------------------------------------------------------------------------
+QImage const& qtSqueezedLabelPrivate::fadeMask(int width, bool leftAligned)
+{
+    if (this->mask.width() != width || this->maskLeftAligned != leftAligned ||
+        this->maskFadeWidth != this->fadeWidth)
+    {
+        // Set up fade gradient
+        int x1, x2;
+        if (leftAligned)
+        {
+            x1 = qMax(0, width - this->fadeWidth);
+            x2 = width;
+        }
+        else
+        {
+            x1 = qMin(width, this->fadeWidth);
+            x2 = 0;
+        }
+        QLinearGradient grad(x1, 0, x2, 0);
+        grad.setColorAt(0.0, Qt::black);
+        grad.setColorAt(0.9, Qt::transparent);
+
+        // Render the mask as a single row, which is stretched to the height
+        // of the text when applied
+        this->mask = QImage{width, 1, QImage::Format_ARGB32_Premultiplied};
+        this->mask.fill(Qt::transparent);
+        QPainter painter{&this->mask};
+        painter.fillRect(this->mask.rect(), grad);
+
+        this->maskLeftAligned = leftAligned;
+        this->maskFadeWidth = this->fadeWidth;
+    }
+
+    return this->mask;
+}
+
 //-----------------------------------------------------------------------------
 int qtSqueezedLabelPrivate::marginsWidth(QFontMetrics const& fm) const
 {
@@ -288,7 +415,7 @@ void qtSqueezedLabel::setTextMargins(qreal left, qreal right)
     {
         d->marginLeft = left;
         d->marginRight = right;
-        d->invalidate(this);
+        d->invalidate();
     }
 }
 
@@ -330,25 +457,16 @@ QSize qtSqueezedLabel::minimumSizeHint() const
 //-----------------------------------------------------------------------------
 bool qtSqueezedLabel::event(QEvent* e)
 {
-    if (e->type() == QEvent::WindowActivate ||
-        e->type() == QEvent::WindowDeactivate)
-    {
-        QTE_D();
-        d->invalidate(this);
-    }
-
     return QLabel::event(e);
 }
 
 //-----------------------------------------------------------------------------
 void qtSqueezedLabel::changeEvent(QEvent* e)
 {
-    if (e->type() == QEvent::FontChange ||
-        e->type() == QEvent::EnabledChange ||
-        e->type() == QEvent::PaletteChange)
+    if (e->type() == QEvent::FontChange)
     {
         QTE_D();
-        d->invalidate(this);
+        d->invalidate();
     }
 
     QLabel::changeEvent(e);
@@ -377,12 +495,8 @@ void qtSqueezedLabel::contextMenuEvent(QContextMenuEvent* e)
 //-----------------------------------------------------------------------------
 void qtSqueezedLabel::moveEvent(QMoveEvent* e)
 {
-    QTE_D();
-
-    // Parent render calls move; don't get stuck in a recursion loop!
-    if (!d->cacheBackground)
-        d->invalidate(this);
-
+    // Moving does not affect elision, and the fade does not depend on what is
+    // underneath the label
     QLabel::moveEvent(e);
 }
 
@@ -390,10 +504,7 @@ void qtSqueezedLabel::moveEvent(QMoveEvent* e)
 void qtSqueezedLabel::resizeEvent(QResizeEvent* e)
 {
     QTE_D();
-
-    // Parent render calls resize; don't get stuck in a recursion loop!
-    if (!d->cacheBackground)
-        d->invalidate(this);
+    d->invalidate();
 
     QLabel::resizeEvent(e);
 }
@@ -403,16 +514,12 @@ void qtSqueezedLabel::paintEvent(QPaintEvent* e)
 {
     QTE_D();
 
-    // Do nothing if drawing background for cache
-    if (d->cacheBackground)
-        return;
-
     // If invalid, or text has changed, recalculate portion to elide
     QString const& text = this->text();
     if (!d->isValid(text))
     {
         d->cachedText = text;
-        d->recalculate(this->size(), this->fontMetrics());
+        d->recalculate(this->size(), this);
     }
 
     e->accept();
@@ -433,38 +540,32 @@ void qtSqueezedLabel::paintEvent(QPaintEvent* e)
     auto const& rect = d->contentsRect(this->rect(), this->fontMetrics());
     if (d->elided && d->elideMode.testFlag(ElideFade))
     {
-        auto const width = rect.width();
+        // Draw text into a transparent layer
+        auto const dpr = this->devicePixelRatioF();
+        auto const layerSize = (QSizeF{rect.size()} * dpr).toSize();
+        if (d->textLayer.size() != layerSize)
+        {
+            d->textLayer =
+                QImage{layerSize, QImage::Format_ARGB32_Premultiplied};
+        }
+        d->textLayer.setDevicePixelRatio(dpr);
+        d->textLayer.fill(Qt::transparent);
 
-        // Draw text
-        style->drawItemText(&painter, rect, static_cast<int>(align),
+        auto const layerRect = QRect{QPoint{}, rect.size()};
+        QPainter layerPainter{&d->textLayer};
+        layerPainter.setFont(this->font());
+        style->drawItemText(&layerPainter, layerRect, static_cast<int>(align),
                             opt.palette, this->isEnabled(), elidedText, role);
 
-        // Set up fade gradient
-        int x1, x2;
-        if (align.testFlag(Qt::AlignLeft))
-        {
-            x1 = qMax(0, width - d->fadeWidth);
-            x2 = width;
-        }
-        else
-        {
-            x1 = qMin(width, d->fadeWidth);
-            x2 = 0;
-        }
-        QLinearGradient grad(x1, 0, x2, 0);
-        grad.setColorAt(0.0, Qt::transparent);
-        grad.setColorAt(0.9, Qt::black);
-
-        // Fade out background for overpainting
-        QImage fadeImage(d->background);
-        QBrush brush(grad);
-        QPainter imagePainter(&fadeImage);
-        imagePainter.setCompositionMode(
+        // Fade out the end of the text by masking its alpha
+        auto const leftAligned = align.testFlag(Qt::AlignLeft);
+        layerPainter.setCompositionMode(
             QPainter::CompositionMode_DestinationIn);
-        imagePainter.fillRect(0, 0, rect.width(), rect.height(), brush);
+        layerPainter.drawImage(layerRect,
+                               d->fadeMask(rect.width(), leftAligned));
+        layerPainter.end();
 
-        // Fade out text by overpainting with blended fade image
-        painter.drawImage(rect.topLeft(), fadeImage);
+        painter.drawImage(rect.topLeft(), d->textLayer);
     }
     else
     {
@@ -4,31 +4,285 @@
 
 #include "qtSvgWidget.h"
 
+#include "../core/qtOnce.h"
+#include "../core/qtThreadPool.h"
+
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPainter>
 #include <QPixmapCache>
+#include <QPointer>
+#include <QSharedPointer>
 #include <QSvgRenderer>
+#include <QThread>
+
+#include <functional>
 
 QTE_IMPLEMENT_D_FUNC(qtSvgWidget)
 
+namespace // anonymous
+{
+
+//-----------------------------------------------------------------------------
+// Parsed SVG resource, shared by all widgets showing the same resource
+struct SvgDocument
+{
+    explicit SvgDocument(QString const& resource)
+        : renderer{resource}, valid{renderer.isValid()},
+          defaultSize{renderer.defaultSize()}
+    {}
+
+    // The renderer is not reentrant; it must be locked while rendering
+    QMutex mutex;
+    QSvgRenderer renderer;
+
+    // Properties of the document, which may be read without locking
+    bool const valid;
+    QSize const defaultSize;
+};
+
+using SvgDocumentPointer = QSharedPointer<SvgDocument>;
+using SvgCallback = std::function<void(QPixmap const&)>;
+
+//-----------------------------------------------------------------------------
+// Process-wide cache of parsed documents and rasterized images
+//
+// Documents are shared by all widgets showing the same resource, and are
+// released when no widget is using them. Rasterized images are stored in the
+// application's QPixmapCache, keyed by resource, size and device pixel ratio.
+// Images which were pre-rendered at build time (see qte_add_svg_atlas) are
+// loaded from resources; others are rendered on the global thread pool, and
+// requests for an image which is already being rendered are merged. The atlas
+// index also records the default size of each pre-rendered document, so that
+// a document need only be parsed if an image must be rendered. The cache is
+// only accessed from the GUI thread.
+class SvgCache
+{
+public:
+    SvgCache() { this->loadAtlases(); }
+
+    SvgDocumentPointer document(QString const& resource);
+    QSize defaultSize(QString const& resource) const;
+
+    static QString key(QString const& resource, QSize size, qreal dpr);
+
+    bool find(QString const& key, QPixmap& out) const;
+
+    void request(SvgDocumentPointer const& document, QString const& key,
+                 QSize size, qreal dpr, SvgCallback callback);
+
+protected:
+    void loadAtlases();
+    void finish(QString const& key, QImage const& image);
+
+    // Pre-rendered images, by key
+    struct AtlasEntry
+    {
+        QString path;
+        qreal dpr;
+    };
+    QHash<QString, AtlasEntry> atlas;
+    QHash<QString, QSize> atlasDefaultSizes;
+
+    QHash<QString, QWeakPointer<SvgDocument>> documents;
+    QHash<QString, QList<SvgCallback>> pending;
+
+    // Context for delivering results to the GUI thread
+    QObject context;
+};
+
+// Never destroyed, so that rendering tasks which finish during application
+// shutdown do not deliver results to a deleted context
+qtLazy<SvgCache> theCache;
+
+//-----------------------------------------------------------------------------
+SvgCache& cache()
+{
+    return *theCache.get([]{ return new SvgCache; });
+}
+
+//-----------------------------------------------------------------------------
+SvgDocumentPointer SvgCache::document(QString const& resource)
+{
+    if (auto document = this->documents.value(resource).toStrongRef())
+        return document;
+
+    // Drop entries for documents that are no longer used
+    for (auto iter = this->documents.begin(); iter != this->documents.end();)
+    {
+        if (iter.value().isNull())
+            iter = this->documents.erase(iter);
+        else
+            ++iter;
+    }
+
+    // The renderer belongs to the GUI thread; if a rendering job releases the
+    // last reference to the document, defer deleting it to the GUI thread
+    auto* const context = &this->context;
+    auto const deleter = [context](SvgDocument* document){
+        if (QThread::currentThread() == context->thread())
+            delete document;
+        else
+            QMetaObject::invokeMethod(
+                context, [document]{ delete document; },
+                Qt::QueuedConnection);
+    };
+
+    auto const document =
+        SvgDocumentPointer{new SvgDocument{resource}, deleter};
+    this->documents.insert(resource, document);
+    return document;
+}
+
+//-----------------------------------------------------------------------------
+QSize SvgCache::defaultSize(QString const& resource) const
+{
+    // Returns an invalid size if the resource is not in an atlas
+    return this->atlasDefaultSizes.value(resource);
+}
+
+//-----------------------------------------------------------------------------
+QString SvgCache::key(QString const& resource, QSize size, qreal dpr)
+{
+    return QString{"qtSvgWidget:%1x%2@%3:%4"}
+        .arg(size.width()).arg(size.height()).arg(dpr).arg(resource);
+}
+
+//-----------------------------------------------------------------------------
+void SvgCache::loadAtlases()
+{
+    QDir const root{":/qtSvgAtlas"};
+    for (auto const& name : root.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        QDir const dir{root.absoluteFilePath(name)};
+        QFile file{dir.absoluteFilePath("index.json")};
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+
+        auto const& index = QJsonDocument::fromJson(file.readAll()).object();
+        for (auto iter = index.begin(); iter != index.end(); ++iter)
+        {
+            auto const& document = iter.value().toObject();
+            auto const defaultSize = QSize{document.value("width").toInt(),
+                                           document.value("height").toInt()};
+            this->atlasDefaultSizes.insert(iter.key(), defaultSize);
+
+            for (auto const& entry : document.value("images").toArray())
+            {
+                auto const& e = entry.toObject();
+                auto const size =
+                    QSize{e.value("width").toInt(), e.value("height").toInt()};
+                auto const dpr = e.value("ratio").toDouble();
+                auto const& image = e.value("image").toString();
+
+                this->atlas.insert(key(iter.key(), size, dpr),
+                                   {dir.absoluteFilePath(image), dpr});
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool SvgCache::find(QString const& key, QPixmap& out) const
+{
+    if (QPixmapCache::find(key, &out))
+        return true;
+
+    // Prefer an exact pre-rendered match over rendering the SVG
+    auto const iter = this->atlas.find(key);
+    if (iter != this->atlas.end() && out.load(iter->path, "PNG"))
+    {
+        out.setDevicePixelRatio(iter->dpr);
+        QPixmapCache::insert(key, out);
+        return true;
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+void SvgCache::request(SvgDocumentPointer const& document, QString const& key,
+                       QSize size, qreal dpr, SvgCallback callback)
+{
+    auto& callbacks = this->pending[key];
+    callbacks.append(std::move(callback));
+    if (callbacks.count() > 1)
+    {
+        // Already being rendered
+        return;
+    }
+
+    auto* const context = &this->context;
+    auto const physicalSize = (QSizeF{size} * dpr).toSize();
+    qtThreadPool::globalInstance()->post(
+        [this, context, document, key, size, dpr, physicalSize]{
+            QImage image{physicalSize, QImage::Format_ARGB32_Premultiplied};
+            image.setDevicePixelRatio(dpr);
+            image.fill(Qt::transparent);
+
+            QMutexLocker lock{&document->mutex};
+            QPainter painter{&image};
+            painter.setRenderHint(QPainter::Antialiasing);
+            document->renderer.render(&painter, QRect{{0, 0}, size});
+            painter.end();
+            lock.unlock();
+
+            QMetaObject::invokeMethod(
+                context, [this, key, image]{ this->finish(key, image); },
+                Qt::QueuedConnection);
+        });
+}
+
+//-----------------------------------------------------------------------------
+void SvgCache::finish(QString const& key, QImage const& image)
+{
+    auto const& pixmap = QPixmap::fromImage(image);
+    QPixmapCache::insert(key, pixmap);
+
+    // Deliver the result directly, so that requesters get it even if the
+    // pixmap was too large to be cached
+    for (auto const& callback : this->pending.take(key))
+        callback(pixmap);
+}
+
+} // namespace <anonymous>
+
 //-----------------------------------------------------------------------------
 class qtSvgWidgetPrivate
 {
 public:
+    bool isValid() const { return this->defaultSize.isValid(); }
     QSize adjustedSize(QSize const& in) const;
 
     QString resource;
-    QSvgRenderer renderer;
+    QSize defaultSize;
+
+    // Parsed document; this is only loaded when an image must be rendered,
+    // or if the resource is not in an atlas (to obtain its default size)
+    SvgDocumentPointer document;
 
     Qt::Alignment alignment = Qt::AlignCenter;
     bool scaled = true;
 
+    // Most recent image received from the cache, and the key of the image
+    // which was last requested; until a request is fulfilled, the previous
+    // image is shown (scaled as needed) in its place
     QPixmap cachedPixmap;
+    QString cachedKey;
+    QString requestedKey;
 };
 
 //-----------------------------------------------------------------------------
 QSize qtSvgWidgetPrivate::adjustedSize(QSize const& in) const
 {
-    auto const baseSize = this->renderer.defaultSize();
+    auto const baseSize = this->defaultSize;
 
     if (this->scaled)
     {
@@ -88,9 +342,21 @@ void qtSvgWidget::setResource(QString const& resource)
     if (d->resource != resource)
     {
         d->resource = resource;
+        d->defaultSize = cache().defaultSize(resource);
+        d->document.clear();
+        if (!d->defaultSize.isValid())
+        {
+            // Not pre-rendered; the document must be parsed to get its size
+            d->document = cache().document(resource);
+            if (d->document->valid)
+                d->defaultSize = d->document->defaultSize;
+        }
         d->cachedPixmap = {};
+        d->cachedKey.clear();
+        d->requestedKey.clear();
 
-        d->renderer.load(resource);
+        this->updateGeometry();
+        this->update();
     }
 }
 
@@ -109,7 +375,7 @@ void qtSvgWidget::setAlignment(Qt::Alignment alignment)
     if (d->alignment != alignment)
     {
         d->alignment = alignment;
-        if (d->renderer.isValid())
+        if (d->isValid())
         {
             this->update();
         }
@@ -131,7 +397,7 @@ void qtSvgWidget::setScaledContents(bool scaled)
     if (d->scaled != scaled)
     {
         d->scaled = scaled;
-        if (d->renderer.isValid())
+        if (d->isValid())
         {
             this->update();
         }
@@ -142,7 +408,7 @@ void qtSvgWidget::setScaledContents(bool scaled)
 QSize qtSvgWidget::sizeHint() const
 {
     QTE_D();
-    return (d->renderer.isValid() ? d->renderer.defaultSize() : QSize{0, 0});
+    return (d->isValid() ? d->defaultSize : QSize{0, 0});
 }
 
 //-----------------------------------------------------------------------------
@@ -172,24 +438,50 @@ void qtSvgWidget::paintEvent(QPaintEvent* e)
         painter.fillRect(this->rect(), brush);
     }
 
-    if (d->renderer.isValid())
+    auto const size =
+        (d->isValid() ? d->adjustedSize(this->size()) : QSize{});
+    if (!size.isEmpty())
     {
-        auto const size = d->adjustedSize(this->size());
         auto const dpr = this->devicePixelRatioF();
-        auto const physicalSize = (QSizeF{size} * dpr).toSize();
+        auto const key = SvgCache::key(d->resource, size, dpr);
 
-        if (d->cachedPixmap.isNull() ||
-            d->cachedPixmap.devicePixelRatioF() != dpr ||
-            d->cachedPixmap.size() != physicalSize)
+        if (key != d->cachedKey)
         {
-            d->cachedPixmap = QPixmap{physicalSize};
-            d->cachedPixmap.setDevicePixelRatio(dpr);
-            d->cachedPixmap.fill(Qt::transparent);
-
-            QPainter pp{&d->cachedPixmap};
+            QPixmap pixmap;
+            if (cache().find(key, pixmap))
+            {
+                d->cachedPixmap = pixmap;
+                d->cachedKey = key;
+            }
+            else if (key != d->requestedKey)
+            {
+                // Rasterize asynchronously; the previous image (if any) is
+                // shown until the result arrives
+                if (!d->document)
+                    d->document = cache().document(d->resource);
+
+                QPointer<qtSvgWidget> self{this};
+                d->requestedKey = key;
+                cache().request(
+                    d->document, key, size, dpr,
+                    [self, key](QPixmap const& pixmap){
+                        if (!self)
+                            return;
+
+                        auto const d = self->d_func();
+                        if (d->requestedKey == key)
+                        {
+                            d->cachedPixmap = pixmap;
+                            d->cachedKey = key;
+                            self->update();
+                        }
+                    });
+            }
+        }
 
-            pp.setRenderHint(QPainter::Antialiasing);
-            d->renderer.render(&pp, QRect{{0, 0}, size});
+        if (d->cachedPixmap.isNull())
+        {
+            return;
         }
 
         auto const r = this->rect();
@@ -205,6 +497,7 @@ void qtSvgWidget::paintEvent(QPaintEvent* e)
         auto const xo = static_cast<int>(static_cast<qreal>(xd) * xs);
         auto const yo = static_cast<int>(static_cast<qreal>(yd) * ys);
 
-        painter.drawPixmap(r.left() + xo, r.top() + yo, d->cachedPixmap);
+        painter.drawPixmap(QRect{{r.left() + xo, r.top() + yo}, size},
+                           d->cachedPixmap);
     }
 }
@@ -5,44 +5,179 @@
 #include "qtThrobber.h"
 
 #include "../core/qtIndexRange.h"
+#include "../core/qtOnce.h"
+#include "../util/qtAnimationDriver.h"
 
+#include <QAbstractAnimation>
 #include <QPainter>
-#include <QTimer>
+#include <QPixmapCache>
+#include <QSet>
+
+#include <qmath.h>
 
 #include <cmath>
 
 QTE_IMPLEMENT_D_FUNC(qtThrobber)
 
+namespace // anonymous
+{
+
+//-----------------------------------------------------------------------------
+// Animation clock shared by all throbbers
+//
+// Throbbers subscribe while they are active and visible; the clock only runs
+// while at least one subscriber is exposed (i.e. neither minimized nor
+// obscured), and each step only repaints subscribers that are exposed. When
+// no subscriber is exposed, the clock stops until a subscriber is painted
+// again, which happens when it is shown or re-exposed. The clock is itself an animation, so
+// that it is advanced in the same frames as other animations when a
+// qtAnimationDriver is installed, and its repaints are coalesced with theirs.
+class ThrobberClock : public QAbstractAnimation
+{
+public:
+    static constexpr int interval = 120;
+
+    int step() const { return this->currentStep; }
+
+    virtual int duration() const override { return -1; }
+
+    void subscribe(qtThrobber* throbber)
+    {
+        this->subscribers.insert(throbber);
+        if (this->state() != QAbstractAnimation::Running)
+            this->start();
+    }
+
+    void unsubscribe(qtThrobber* throbber)
+    {
+        this->subscribers.remove(throbber);
+        if (this->subscribers.isEmpty())
+            this->stop();
+    }
+
+    void wake()
+    {
+        if (!this->subscribers.isEmpty() &&
+            this->state() != QAbstractAnimation::Running)
+        {
+            this->start();
+        }
+    }
+
+protected:
+    virtual void updateCurrentTime(int time) override
+    {
+        // Advance by one step per elapsed interval; like a timer, steps that
+        // were missed (e.g. because the event loop was busy) are not repeated
+        auto const tick = time / interval;
+        if (tick != this->lastTick)
+        {
+            this->lastTick = tick;
+            this->advance();
+        }
+    }
+
+    virtual void updateState(QAbstractAnimation::State newState,
+                             QAbstractAnimation::State) override
+    {
+        // The current time restarts from zero when the clock is restarted
+        if (newState == QAbstractAnimation::Stopped)
+            this->lastTick = 0;
+    }
+
+    void advance()
+    {
+        ++this->currentStep;
+
+        auto exposed = false;
+        for (auto* const throbber : this->subscribers)
+        {
+            if (!throbber->window()->isMinimized() &&
+                !throbber->visibleRegion().isEmpty())
+            {
+                qtAnimationDriver::scheduleUpdate(throbber);
+                exposed = true;
+            }
+        }
+
+        if (!exposed)
+            this->stop();
+    }
+
+    QSet<qtThrobber*> subscribers;
+    int currentStep = 0;
+    int lastTick = 0;
+};
+
+// Never destroyed; as a QObject, the clock must not be destroyed during static
+// destruction, which happens after the application has been destroyed
+qtLazy<ThrobberClock> theClock;
+
+//-----------------------------------------------------------------------------
+ThrobberClock& throbberClock()
+{
+    return *theClock.get([]{ return new ThrobberClock; });
+}
+
+} // namespace <anonymous>
+
 //-----------------------------------------------------------------------------
 class qtThrobberPrivate
 {
 public:
     constexpr static auto dotCount = 12;
 
-    QTimer timer;
-    int step = -1;
+    int step() const;
+    void updateSubscription(qtThrobber* q);
+
+    QPixmap frame(int size, qreal dpr, QColor const& color) const;
+    QColor colorAt(QColor const& base, int pos, int step) const;
+
+    bool active = false;
+    bool subscribed = false;
+    int phase = 0;
     int maxSize = -1;
     qreal opacity = 0.0;
     qtThrobber::Style style = qtThrobber::BlackAndWhite;
-
-    QBrush brushAt(QPalette const& palette, int pos,
-                   QPalette::ColorGroup group, QPalette::ColorRole role);
 };
 
 //-----------------------------------------------------------------------------
-QBrush qtThrobberPrivate::brushAt(
-    QPalette const& palette, int pos,
-    QPalette::ColorGroup group, QPalette::ColorRole role)
+int qtThrobberPrivate::step() const
+{
+    constexpr auto k = qtThrobberPrivate::dotCount;
+    if (!this->active)
+        return -1;
+
+    auto const step = (throbberClock().step() - this->phase) % k;
+    return (step < 0 ? step + k : step);
+}
+
+//-----------------------------------------------------------------------------
+void qtThrobberPrivate::updateSubscription(qtThrobber* q)
+{
+    auto const subscribe = this->active && q->isVisible();
+    if (subscribe != this->subscribed)
+    {
+        this->subscribed = subscribe;
+        if (subscribe)
+            throbberClock().subscribe(q);
+        else
+            throbberClock().unsubscribe(q);
+    }
+}
+
+//-----------------------------------------------------------------------------
+QColor qtThrobberPrivate::colorAt(QColor const& base, int pos, int step) const
 {
     constexpr auto k = qtThrobberPrivate::dotCount;
     constexpr auto ki = qreal{1.0} / static_cast<qreal>(k - 1);
 
-    auto a = static_cast<qreal>((k + pos - this->step) % k) * ki;
+    auto a = static_cast<qreal>((k + pos - step) % k) * ki;
     a = std::pow(a, 2.2);
 
     if (this->style == qtThrobber::TranslucentForeground)
     {
-        auto c = palette.color(group, role);
+        auto c = base;
         c.setAlphaF(a);
         return c;
     }
@@ -51,28 +186,69 @@ QBrush qtThrobberPrivate::brushAt(
     return QColor::fromRgbF(a, a, a);
 }
 
+//-----------------------------------------------------------------------------
+QPixmap qtThrobberPrivate::frame(
+    int size, qreal dpr, QColor const& color) const
+{
+    // Frames depend on the color only for the translucent style
+    auto const translucent =
+        (this->style == qtThrobber::TranslucentForeground);
+    auto const step = this->step();
+    auto const key = QString{"qtThrobber:%1:%2@%3:%4:%5"}
+        .arg(static_cast<int>(this->style)).arg(size).arg(dpr)
+        .arg(translucent ? color.rgba() : 0u, 8, 16, QChar{'0'})
+        .arg(step);
+
+    QPixmap pixmap;
+    if (QPixmapCache::find(key, &pixmap))
+    {
+        return pixmap;
+    }
+
+    // Render the frame; the throbber is drawn at a nominal radius of 25 units,
+    // centered in a pixmap of the requested (logical) size
+    auto const physicalSize = qCeil(static_cast<qreal>(size) * dpr);
+    pixmap = QPixmap{physicalSize, physicalSize};
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter{&pixmap};
+    auto const s = static_cast<qreal>(size) * 0.5;
+    const qreal r = 3.0;
+
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.translate(s, s);
+    painter.scale(s * 0.04, s * 0.04);
+    painter.setPen(Qt::NoPen);
+
+    for (auto const i : qtIndexRange(qtThrobberPrivate::dotCount))
+    {
+        painter.setBrush(this->colorAt(color, i, step));
+        painter.drawEllipse(QRectF{-20.0 - r, -r, 2.0 * r, 2.0 * r});
+        painter.rotate(360.0 / qtThrobberPrivate::dotCount);
+    }
+    painter.end();
+
+    QPixmapCache::insert(key, pixmap);
+    return pixmap;
+}
+
 //-----------------------------------------------------------------------------
 qtThrobber::qtThrobber(QWidget* parent)
     : QWidget(parent), d_ptr(new qtThrobberPrivate)
 {
-    QTE_D();
-
     this->setBackgroundRole(QPalette::Window);
     this->setForegroundRole(QPalette::WindowText);
-
-    connect(
-        &d->timer, &QTimer::timeout, this,
-        [this, d]{
-            d->step = (d->step + 1) % qtThrobberPrivate::dotCount;
-            this->update();
-        });
-
-    d->timer.setInterval(120);
 }
 
 //-----------------------------------------------------------------------------
 qtThrobber::~qtThrobber()
 {
+    QTE_D();
+    if (d->subscribed)
+    {
+        throbberClock().unsubscribe(this);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -85,24 +261,19 @@ QSize qtThrobber::minimumSizeHint() const
 void qtThrobber::setActive(bool active)
 {
     QTE_D();
-    if (active)
-    {
-        d->step = 0;
-        d->timer.start();
-    }
-    else
-    {
-        d->timer.stop();
-        d->step = -1;
-        this->update();
-    }
+
+    // Restart the animation at the first step on (re)activation
+    d->active = active;
+    d->phase = throbberClock().step();
+    d->updateSubscription(this);
+    this->update();
 }
 
 //-----------------------------------------------------------------------------
 bool qtThrobber::isActive() const
 {
     QTE_D();
-    return d->timer.isActive();
+    return d->active;
 }
 
 //-----------------------------------------------------------------------------
@@ -150,13 +321,35 @@ int qtThrobber::maxThrobberSize() const
     return d->maxSize;
 }
 
+//-----------------------------------------------------------------------------
+void qtThrobber::showEvent(QShowEvent* e)
+{
+    QTE_D();
+    QWidget::showEvent(e);
+    d->updateSubscription(this);
+}
+
+//-----------------------------------------------------------------------------
+void qtThrobber::hideEvent(QHideEvent* e)
+{
+    QTE_D();
+    QWidget::hideEvent(e);
+    d->updateSubscription(this);
+}
+
 //-----------------------------------------------------------------------------
 void qtThrobber::paintEvent(QPaintEvent* e)
 {
     QTE_D();
 
+    // Restart the clock if it was stopped while no throbber was exposed
+    if (d->subscribed)
+    {
+        throbberClock().wake();
+    }
+
     // Do nothing if inactive
-    if (d->step < 0)
+    if (!d->active)
     {
         QWidget::paintEvent(e);
         return;
@@ -164,7 +357,6 @@ void qtThrobber::paintEvent(QPaintEvent* e)
 
     qreal x = this->width() * 0.5, y = this->height() * 0.5;
     qreal s = qMin(x, y), m = d->maxSize;
-    const qreal r = 3.0;
 
     if (m > 0)
     {
@@ -172,11 +364,10 @@ void qtThrobber::paintEvent(QPaintEvent* e)
     }
 
     QPainter painter(this);
-    auto palette = this->palette();
+    auto const& palette = this->palette();
 
     auto const active = this->isActiveWindow();
     auto const cg = (active ? QPalette::Active : QPalette::Inactive);
-    auto const cr = this->foregroundRole();
 
     if (d->opacity > 0.0)
     {
@@ -185,18 +376,13 @@ void qtThrobber::paintEvent(QPaintEvent* e)
         painter.fillRect(this->rect(), c);
     }
 
-    painter.setRenderHint(QPainter::Antialiasing);
-    painter.translate(x, y);
-    painter.scale(s * 0.04, s * 0.04);
-
-    painter.setPen(Qt::NoPen);
-
-    for (auto const i : qtIndexRange(qtThrobberPrivate::dotCount))
+    // Draw the pre-rendered frame for the current step
+    auto const size = qFloor(2.0 * s);
+    if (size > 0)
     {
-        painter.save();
-        painter.setBrush(d->brushAt(palette, i, cg, cr));
-        painter.rotate((360.0 / qtThrobberPrivate::dotCount) * i);
-        painter.drawEllipse(QRectF{-20.0 - r, -r, 2.0 * r, 2.0 * r});
-        painter.restore();
+        auto const& color = palette.color(cg, this->foregroundRole());
+        auto const& frame = d->frame(size, this->devicePixelRatioF(), color);
+        auto const offset = 0.5 * static_cast<qreal>(size);
+        painter.drawPixmap(QPointF{x - offset, y - offset}, frame);
     }
 }
@@ -52,6 +52,8 @@ protected:
     QTE_DECLARE_PRIVATE_RPTR(qtThrobber)
 
     void paintEvent(QPaintEvent*);
+    void showEvent(QShowEvent*);
+    void hideEvent(QHideEvent*);
 
 private:
     QTE_DECLARE_PRIVATE(qtThrobber)
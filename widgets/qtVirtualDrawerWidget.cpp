@@ -0,0 +1,891 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#include "qtVirtualDrawerWidget.h"
+
+#include <QAbstractItemModel>
+#include <QApplication>
+#include <QHBoxLayout>
+#include <QHash>
+#include <QLabel>
+#include <QMetaProperty>
+#include <QPointer>
+#include <QScrollBar>
+#include <QSet>
+#include <QStyle>
+#include <QVector>
+
+#include <algorithm>
+#include <limits>
+
+#include "qtExpander.h"
+
+QTE_IMPLEMENT_D_FUNC(qtVirtualDrawerWidget)
+
+namespace // anonymous
+{
+
+//-----------------------------------------------------------------------------
+struct Row
+{
+  QModelIndex index;
+  int depth;
+};
+
+//-----------------------------------------------------------------------------
+class RowWidget : public QWidget
+{
+public:
+  RowWidget(QWidget* parent) : QWidget(parent), row(-1)
+    {
+    this->layout = new QHBoxLayout;
+    this->layout->setContentsMargins(0, 0, 0, 0);
+    this->setLayout(this->layout);
+
+    this->expander = new qtExpander(false, this);
+    this->layout->addWidget(this->expander);
+    }
+
+  QHBoxLayout* layout;
+  qtExpander* expander;
+  QVector<QWidget*> cells;
+
+  QPersistentModelIndex index;
+  int row;
+};
+
+} // namespace <anonymous>
+
+//-----------------------------------------------------------------------------
+class qtVirtualDrawerWidgetPrivate
+{
+public:
+  qtVirtualDrawerWidgetPrivate(qtVirtualDrawerWidget* q)
+    : q_ptr(q), model(0), expanderPolicy(qtDrawer::ExpanderAsNeeded),
+      rowHeight(0), automaticRowHeight(0), indentStep(-1),
+      rebuildPending(false), binding(false) {}
+
+  void scheduleRebuild();
+  void ensureRows();
+  void rebuild();
+  void appendRows(QModelIndex const& parent, int depth, QVector<Row>& out);
+
+  int findRow(QModelIndex const& index);
+  int effectiveRowHeight();
+  int indent();
+
+  void updateScrollBars();
+  void layoutRows();
+  void release(RowWidget* widget);
+  void releaseAll();
+
+  RowWidget* createRow();
+  void bind(RowWidget* widget, int row);
+  void commit(RowWidget* widget, int column);
+  void updateColumnWidth(int column, int width);
+  void updateExpander(RowWidget* widget);
+
+  QPointer<QAbstractItemModel> model;
+  QList<QMetaObject::Connection> modelConnections;
+
+  qtDrawer::ExpanderPolicy expanderPolicy;
+  QSet<QPersistentModelIndex> expanded;
+
+  QVector<Row> rows;
+  QHash<QModelIndex, RowWidget*> active;
+  QList<RowWidget*> spare;
+  QVector<int> columnWidths;
+
+  int rowHeight;
+  int automaticRowHeight;
+  int indentStep;
+  bool rebuildPending;
+  bool binding;
+
+protected:
+  QTE_DECLARE_PUBLIC_PTR(qtVirtualDrawerWidget)
+
+private:
+  QTE_DECLARE_PUBLIC(qtVirtualDrawerWidget)
+};
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidgetPrivate::scheduleRebuild()
+{
+  // Structural changes often arrive in bursts (e.g. when a model is being
+  // populated); coalesce them into a single rebuild
+  if (!this->rebuildPending)
+    {
+    QTE_Q(qtVirtualDrawerWidget);
+    this->rebuildPending = true;
+    QMetaObject::invokeMethod(q, [this]{
+      if (this->rebuildPending)
+        {
+        this->rebuild();
+        }
+      }, Qt::QueuedConnection);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidgetPrivate::ensureRows()
+{
+  if (this->rebuildPending)
+    {
+    this->rebuild();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidgetPrivate::rebuild()
+{
+  this->rebuildPending = false;
+
+  // Indices held by row widgets may now refer to different items; release
+  // all widgets so that they are rebound
+  this->releaseAll();
+  this->rows.clear();
+
+  // Discard expansion state of items that no longer exist
+  auto iter = this->expanded.begin();
+  while (iter != this->expanded.end())
+    {
+    if (iter->isValid())
+      {
+      ++iter;
+      }
+    else
+      {
+      iter = this->expanded.erase(iter);
+      }
+    }
+
+  if (this->model)
+    {
+    this->appendRows(QModelIndex(), 0, this->rows);
+    }
+
+  this->updateScrollBars();
+  this->layoutRows();
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidgetPrivate::appendRows(
+  QModelIndex const& parent, int depth, QVector<Row>& out)
+{
+  // Only expanded subtrees are visited; collapsed subtrees are left entirely
+  // to the model
+  auto const count = this->model->rowCount(parent);
+  for (int i = 0; i < count; ++i)
+    {
+    auto const index = this->model->index(i, 0, parent);
+    out.append(Row{index, depth});
+    if (this->expanded.contains(index) && this->model->hasChildren(index))
+      {
+      this->appendRows(index, depth + 1, out);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+int qtVirtualDrawerWidgetPrivate::findRow(QModelIndex const& index)
+{
+  this->ensureRows();
+
+  // Check bound widgets first; this is the usual case when a drawer is
+  // toggled by its expander
+  if (auto* const widget = this->active.value(index, 0))
+    {
+    return widget->row;
+    }
+
+  for (int i = 0; i < this->rows.count(); ++i)
+    {
+    if (this->rows[i].index == index)
+      {
+      return i;
+      }
+    }
+
+  return -1;
+}
+
+//-----------------------------------------------------------------------------
+int qtVirtualDrawerWidgetPrivate::effectiveRowHeight()
+{
+  if (this->rowHeight > 0)
+    {
+    return this->rowHeight;
+    }
+
+  if (this->automaticRowHeight <= 0 && !this->rows.isEmpty())
+    {
+    // Determine row height from the first row
+    auto* const widget = this->createRow();
+    this->bind(widget, 0);
+    this->automaticRowHeight = qMax(1, widget->sizeHint().height());
+    widget->index = QPersistentModelIndex();
+    widget->row = -1;
+    widget->hide();
+    this->spare.append(widget);
+    }
+
+  return qMax(1, this->automaticRowHeight);
+}
+
+//-----------------------------------------------------------------------------
+int qtVirtualDrawerWidgetPrivate::indent()
+{
+  if (this->indentStep < 0)
+    {
+    // This must match qtDrawerPrivate::setIndent, so that virtualized and
+    // non-virtualized drawers look the same
+    QTE_Q(qtVirtualDrawerWidget);
+    QStyle* style = QApplication::style();
+    int s = style->layoutSpacing(QSizePolicy::ToolButton,
+                                 QSizePolicy::DefaultType,
+                                 Qt::Horizontal);
+    if (s < 0)
+      {
+      s = style->pixelMetric(QStyle::PM_DefaultLayoutSpacing);
+      }
+    this->indentStep = qtExpander::size(q->style()).width() + s;
+    }
+
+  return this->indentStep;
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidgetPrivate::updateScrollBars()
+{
+  QTE_Q(qtVirtualDrawerWidget);
+
+  // The range depends on the row count, so apply any pending changes first
+  this->ensureRows();
+
+  auto const h = this->effectiveRowHeight();
+  auto const viewportHeight = q->viewport()->height();
+  auto const contentHeight = static_cast<qint64>(this->rows.count()) * h;
+  auto const range = qMin(qMax(qint64{0}, contentHeight - viewportHeight),
+                          qint64{std::numeric_limits<int>::max()});
+
+  auto* const sb = q->verticalScrollBar();
+  sb->setSingleStep(h);
+  sb->setPageStep(viewportHeight);
+  sb->setRange(0, static_cast<int>(range));
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidgetPrivate::layoutRows()
+{
+  QTE_Q(qtVirtualDrawerWidget);
+
+  this->ensureRows();
+
+  auto const h = this->effectiveRowHeight();
+  auto const width = q->viewport()->width();
+  auto const offset = q->verticalScrollBar()->value();
+  auto const first = offset / h;
+  auto const last =
+    qMin(this->rows.count(), (offset + q->viewport()->height()) / h + 1);
+
+  // Reuse widgets that are already bound to rows that remain visible, so
+  // that scrolling only rebinds the rows that scrolled into view
+  QHash<QModelIndex, RowWidget*> previous;
+  previous.swap(this->active);
+
+  QVector<int> unbound;
+  for (int r = first; r < last; ++r)
+    {
+    auto const& index = this->rows[r].index;
+    if (auto* const widget = previous.take(index))
+      {
+      widget->row = r;
+      this->active.insert(index, widget);
+      }
+    else
+      {
+      unbound.append(r);
+      }
+    }
+
+  // Release widgets that are no longer needed, except for those holding the
+  // focus, which would otherwise lose any edit in progress
+  auto* const focus = QApplication::focusWidget();
+  foreach (auto* const widget, previous)
+    {
+    if (focus && widget->isAncestorOf(focus) && widget->index.isValid())
+      {
+      widget->row = this->findRow(widget->index);
+      if (widget->row >= 0)
+        {
+        this->active.insert(widget->index, widget);
+        continue;
+        }
+      }
+    this->release(widget);
+    }
+
+  // Bind rows that scrolled into view to spare widgets
+  foreach (auto const r, unbound)
+    {
+    auto* const widget =
+      (this->spare.isEmpty() ? this->createRow() : this->spare.takeLast());
+    this->bind(widget, r);
+    this->active.insert(this->rows[r].index, widget);
+    }
+
+  // Position active widgets
+  foreach (auto* const widget, this->active)
+    {
+    widget->setGeometry(0, (widget->row * h) - offset, width, h);
+    widget->show();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidgetPrivate::release(RowWidget* widget)
+{
+  // Write back any changes before the widget is recycled
+  for (int column = 0; column < widget->cells.count(); ++column)
+    {
+    this->commit(widget, column);
+    }
+
+  widget->hide();
+  widget->index = QPersistentModelIndex();
+  widget->row = -1;
+  this->spare.append(widget);
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidgetPrivate::releaseAll()
+{
+  foreach (auto* const widget, this->active)
+    this->release(widget);
+  this->active.clear();
+}
+
+//-----------------------------------------------------------------------------
+RowWidget* qtVirtualDrawerWidgetPrivate::createRow()
+{
+  QTE_Q(qtVirtualDrawerWidget);
+
+  auto* const widget = new RowWidget(q->viewport());
+  widget->hide();
+
+  q->connect(widget->expander, &QAbstractButton::toggled, q,
+             [q, widget](bool state){
+               if (widget->index.isValid())
+                 {
+                 q->setExpanded(widget->index, state);
+                 }
+             });
+
+  return widget;
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidgetPrivate::bind(RowWidget* widget, int row)
+{
+  QTE_Q(qtVirtualDrawerWidget);
+
+  auto const& entry = this->rows[row];
+  auto const& index = entry.index;
+
+  widget->index = index;
+  widget->row = row;
+
+  this->updateExpander(widget);
+  widget->layout->setContentsMargins(
+    this->indent() * entry.depth, 0, 0, 0);
+
+  // Create any missing content widgets
+  auto const columns = this->model->columnCount(index.parent());
+  while (widget->cells.count() < columns)
+    {
+    auto const column = widget->cells.count();
+    auto* const cell = q->createWidget(column, widget);
+    widget->cells.append(cell);
+
+    // Write user changes back to the model as they are made, if the widget
+    // reports them
+    auto const property = cell->metaObject()->userProperty();
+    if (property.hasNotifySignal())
+      {
+      auto const* const mo = &qtVirtualDrawerWidget::staticMetaObject;
+      auto const slot = mo->method(mo->indexOfSlot("widgetDataChanged()"));
+      QObject::connect(cell, property.notifySignal(), q, slot);
+      }
+
+    widget->layout->addWidget(cell, (column ? 0 : 1));
+    if (column && this->columnWidths.value(column) > 0)
+      {
+      cell->setFixedWidth(this->columnWidths[column]);
+      }
+    }
+
+  // Populate content widgets; changes made while doing so are not user edits
+  this->binding = true;
+  for (int column = 0; column < widget->cells.count(); ++column)
+    {
+    auto* const cell = widget->cells[column];
+    if (column < columns)
+      {
+      q->setWidgetData(cell, index.sibling(index.row(), column));
+      cell->show();
+      if (column)
+        {
+        this->updateColumnWidth(column, cell->sizeHint().width());
+        }
+      }
+    else
+      {
+      cell->hide();
+      }
+    }
+  this->binding = false;
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidgetPrivate::commit(RowWidget* widget, int column)
+{
+  QTE_Q(qtVirtualDrawerWidget);
+
+  auto const& index = widget->index;
+  if (this->binding || !this->model || !index.isValid() ||
+      column >= this->model->columnCount(index.parent()))
+    {
+    return;
+    }
+
+  q->setModelData(widget->cells[column], index.sibling(index.row(), column));
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidgetPrivate::updateColumnWidth(int column, int width)
+{
+  // Columns other than the first have the width of the widest content seen so
+  // far, so that they line up as they would in a grid
+  if (column >= this->columnWidths.count())
+    {
+    this->columnWidths.resize(column + 1);
+    }
+  if (width <= this->columnWidths[column])
+    {
+    return;
+    }
+
+  this->columnWidths[column] = width;
+
+  auto const apply = [column, width](RowWidget* widget){
+    if (column < widget->cells.count())
+      {
+      widget->cells[column]->setFixedWidth(width);
+      }
+  };
+  foreach (auto* const widget, this->active)
+    apply(widget);
+  foreach (auto* const widget, this->spare)
+    apply(widget);
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidgetPrivate::updateExpander(RowWidget* widget)
+{
+  auto const& index = widget->index;
+  auto const hasChildren = this->model->hasChildren(index);
+  auto const alwaysShown =
+    (this->expanderPolicy == qtDrawer::ExpanderAlwaysShown);
+
+  widget->expander->blockSignals(true);
+  widget->expander->setChecked(this->expanded.contains(index));
+  widget->expander->setEnabled(hasChildren);
+  widget->expander->setVisible(hasChildren || alwaysShown);
+  widget->expander->blockSignals(false);
+}
+
+//-----------------------------------------------------------------------------
+qtVirtualDrawerWidget::qtVirtualDrawerWidget(QWidget* parent)
+  : QAbstractScrollArea(parent),
+    d_ptr(new qtVirtualDrawerWidgetPrivate(this))
+{
+  this->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+}
+
+//-----------------------------------------------------------------------------
+qtVirtualDrawerWidget::~qtVirtualDrawerWidget()
+{
+  QTE_D(qtVirtualDrawerWidget);
+
+  foreach (auto const& connection, d->modelConnections)
+    QObject::disconnect(connection);
+}
+
+//-----------------------------------------------------------------------------
+QAbstractItemModel* qtVirtualDrawerWidget::model() const
+{
+  QTE_D_CONST(qtVirtualDrawerWidget);
+  return d->model;
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidget::setModel(QAbstractItemModel* model)
+{
+  QTE_D(qtVirtualDrawerWidget);
+
+  if (d->model == model)
+    {
+    return;
+    }
+
+  foreach (auto const& connection, d->modelConnections)
+    QObject::disconnect(connection);
+  d->modelConnections.clear();
+
+  // Discard widgets entirely; the new model may have different columns
+  d->releaseAll();
+  qDeleteAll(d->spare);
+  d->spare.clear();
+  d->columnWidths.clear();
+  d->automaticRowHeight = 0;
+  d->expanded.clear();
+
+  d->model = model;
+
+  if (model)
+    {
+    auto const rebuild = [d]{ d->scheduleRebuild(); };
+    auto const refresh = [d](QModelIndex const& topLeft,
+                             QModelIndex const& bottomRight){
+      // Rebind visible widgets whose data changed; there are only as many of
+      // these as fit in the viewport
+      if (d->rebuildPending)
+        {
+        return;
+        }
+      foreach (auto* const widget, d->active)
+        {
+        auto const& index = widget->index;
+        if (index.parent() == topLeft.parent() &&
+            index.row() >= topLeft.row() && index.row() <= bottomRight.row())
+          {
+          d->bind(widget, widget->row);
+          }
+        }
+    };
+
+    d->modelConnections
+      << connect(model, &QAbstractItemModel::dataChanged, this, refresh)
+      << connect(model, &QAbstractItemModel::rowsInserted, this, rebuild)
+      << connect(model, &QAbstractItemModel::rowsRemoved, this, rebuild)
+      << connect(model, &QAbstractItemModel::rowsMoved, this, rebuild)
+      << connect(model, &QAbstractItemModel::columnsInserted, this, rebuild)
+      << connect(model, &QAbstractItemModel::columnsRemoved, this, rebuild)
+      << connect(model, &QAbstractItemModel::layoutChanged, this, rebuild)
+      << connect(model, &QAbstractItemModel::modelReset, this, rebuild)
+      << connect(model, &QObject::destroyed, this, rebuild);
+    }
+
+  d->rebuild();
+}
+
+//-----------------------------------------------------------------------------
+int qtVirtualDrawerWidget::rowHeight() const
+{
+  QTE_D_CONST(qtVirtualDrawerWidget);
+  return d->rowHeight;
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidget::setRowHeight(int height)
+{
+  QTE_D(qtVirtualDrawerWidget);
+
+  if (d->rowHeight != height)
+    {
+    d->rowHeight = height;
+    d->updateScrollBars();
+    d->layoutRows();
+    }
+}
+
+//-----------------------------------------------------------------------------
+qtDrawer::ExpanderPolicy qtVirtualDrawerWidget::expanderPolicy() const
+{
+  QTE_D_CONST(qtVirtualDrawerWidget);
+  return d->expanderPolicy;
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidget::setExpanderPolicy(
+  qtDrawer::ExpanderPolicy newPolicy)
+{
+  QTE_D(qtVirtualDrawerWidget);
+
+  if (d->expanderPolicy != newPolicy)
+    {
+    d->expanderPolicy = newPolicy;
+    foreach (auto* const widget, d->active)
+      d->updateExpander(widget);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool qtVirtualDrawerWidget::isExpanded(QModelIndex const& index) const
+{
+  QTE_D_CONST(qtVirtualDrawerWidget);
+  return d->expanded.contains(index.sibling(index.row(), 0));
+}
+
+//-----------------------------------------------------------------------------
+int qtVirtualDrawerWidget::visibleRowCount() const
+{
+  QTE_D_CONST(qtVirtualDrawerWidget);
+  return d->rows.count();
+}
+
+//-----------------------------------------------------------------------------
+QWidget* qtVirtualDrawerWidget::indexWidget(QModelIndex const& index) const
+{
+  QTE_D_CONST(qtVirtualDrawerWidget);
+
+  if (auto* const widget = d->active.value(index.sibling(index.row(), 0), 0))
+    {
+    return widget->cells.value(index.column(), 0);
+    }
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidget::setExpanded(QModelIndex const& index, bool state)
+{
+  QTE_D(qtVirtualDrawerWidget);
+
+  if (!d->model || index.model() != d->model)
+    {
+    return;
+    }
+
+  auto const key = index.sibling(index.row(), 0);
+  if (d->expanded.contains(key) == state)
+    {
+    return;
+    }
+
+  // Apply any pending structural changes first, so that the splice below
+  // operates on an up to date row list
+  d->ensureRows();
+
+  if (state)
+    {
+    if (d->model->canFetchMore(key))
+      {
+      d->model->fetchMore(key);
+      }
+    d->expanded.insert(key);
+    }
+  else
+    {
+    d->expanded.remove(key);
+    }
+
+  // Splice the drawer's contents into or out of the row list; if the drawer
+  // is itself hidden, there is nothing to do besides recording its state
+  auto const row = d->findRow(key);
+  if (row >= 0)
+    {
+    auto const depth = d->rows[row].depth;
+    auto const first = row + 1;
+    auto last = first;
+    auto delta = 0;
+    if (state)
+      {
+      QVector<Row> children;
+      if (d->model->hasChildren(key))
+        {
+        d->appendRows(key, depth + 1, children);
+        }
+      d->rows.insert(first, children.count(), Row());
+      std::copy(children.begin(), children.end(), d->rows.begin() + first);
+      delta = children.count();
+      }
+    else
+      {
+      while (last < d->rows.count() && d->rows[last].depth > depth)
+        {
+        ++last;
+        }
+      d->rows.remove(first, last - first);
+      delta = first - last;
+      }
+
+    // Renumber bound widgets below the drawer, and release those that were
+    // bound to rows inside a drawer that was collapsed
+    auto iter = d->active.begin();
+    while (iter != d->active.end())
+      {
+      auto* const widget = iter.value();
+      if (widget->row >= last)
+        {
+        widget->row += delta;
+        }
+      else if (widget->row >= first)
+        {
+        d->release(widget);
+        iter = d->active.erase(iter);
+        continue;
+        }
+      ++iter;
+      }
+
+    if (auto* const widget = d->active.value(key, 0))
+      {
+      d->updateExpander(widget);
+      }
+
+    d->updateScrollBars();
+    d->layoutRows();
+    }
+
+  emit this->expandToggled(key, state);
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidget::scrollTo(QModelIndex const& index)
+{
+  QTE_D(qtVirtualDrawerWidget);
+
+  if (!d->model || index.model() != d->model)
+    {
+    return;
+    }
+
+  // Expand ancestors
+  QModelIndexList ancestors;
+  for (auto p = index.parent(); p.isValid(); p = p.parent())
+    {
+    ancestors.prepend(p);
+    }
+  foreach (auto const& p, ancestors)
+    this->setExpanded(p, true);
+
+  auto const row = d->findRow(index.sibling(index.row(), 0));
+  if (row < 0)
+    {
+    return;
+    }
+
+  auto const h = d->effectiveRowHeight();
+  auto const top = row * h;
+  auto* const sb = this->verticalScrollBar();
+  if (top < sb->value())
+    {
+    sb->setValue(top);
+    }
+  else if (top + h > sb->value() + this->viewport()->height())
+    {
+    sb->setValue(top + h - this->viewport()->height());
+    }
+}
+
+//-----------------------------------------------------------------------------
+QWidget* qtVirtualDrawerWidget::createWidget(int column, QWidget* parent)
+{
+  Q_UNUSED(column)
+  return new QLabel(parent);
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidget::setWidgetData(
+  QWidget* widget, QModelIndex const& index)
+{
+  if (auto* const label = qobject_cast<QLabel*>(widget))
+    {
+    label->setText(index.data(Qt::DisplayRole).toString());
+    return;
+    }
+
+  auto const property = widget->metaObject()->userProperty();
+  if (property.isValid())
+    {
+    property.write(widget, index.data(Qt::EditRole));
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidget::setModelData(
+  QWidget* widget, QModelIndex const& index)
+{
+  if (qobject_cast<QLabel*>(widget))
+    {
+    return;
+    }
+
+  auto const property = widget->metaObject()->userProperty();
+  if (property.isValid())
+    {
+    auto const value = property.read(widget);
+    if (value != index.data(Qt::EditRole))
+      {
+      this->model()->setData(index, value, Qt::EditRole);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidget::widgetDataChanged()
+{
+  QTE_D(qtVirtualDrawerWidget);
+
+  // Find the row and column of the content widget that changed
+  auto* const cell = qobject_cast<QWidget*>(this->sender());
+  foreach (auto* const widget, d->active)
+    {
+    auto const column = widget->cells.indexOf(cell);
+    if (column >= 0)
+      {
+      d->commit(widget, column);
+      return;
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidget::scrollContentsBy(int dx, int dy)
+{
+  Q_UNUSED(dx)
+  Q_UNUSED(dy)
+
+  QTE_D(qtVirtualDrawerWidget);
+  d->layoutRows();
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidget::resizeEvent(QResizeEvent* e)
+{
+  QTE_D(qtVirtualDrawerWidget);
+
+  QAbstractScrollArea::resizeEvent(e);
+  d->updateScrollBars();
+  d->layoutRows();
+}
+
+//-----------------------------------------------------------------------------
+void qtVirtualDrawerWidget::changeEvent(QEvent* e)
+{
+  QTE_D(qtVirtualDrawerWidget);
+
+  QAbstractScrollArea::changeEvent(e);
+
+  if (e->type() == QEvent::StyleChange || e->type() == QEvent::FontChange)
+    {
+    // Metrics depend on the style and font
+    d->indentStep = -1;
+    d->automaticRowHeight = 0;
+    d->releaseAll();
+    d->updateScrollBars();
+    d->layoutRows();
+    }
+}
@@ -0,0 +1,119 @@
+// This file is part of qtExtensions, and is distributed under the
+// OSI-approved BSD 3-Clause License. See top-level LICENSE file or
+// https://github.com/Kitware/qtExtensions/blob/master/LICENSE for details.
+
+#ifndef __qtVirtualDrawerWidget_h
+#define __qtVirtualDrawerWidget_h
+
+#include <QAbstractScrollArea>
+#include <QModelIndex>
+
+#include "../core/qtGlobal.h"
+
+#include "qtDrawer.h"
+
+class QAbstractItemModel;
+
+class qtVirtualDrawerWidgetPrivate;
+
+/// Model-backed, virtualized drawer tree.
+///
+/// This widget presents the rows of a (tree) item model as a hierarchy of
+/// drawers, in the same manner as qtDrawerWidget. Unlike qtDrawerWidget,
+/// however, content widgets are only created for the rows that are currently
+/// in the viewport; as the view is scrolled, the widgets of rows that leave
+/// the viewport are recycled for rows that enter it. The contents of collapsed
+/// drawers are not represented at all, except by the model itself. As a
+/// result, the number of widgets (and the cost of creating them) depends only
+/// on the size of the viewport, not on the number of rows in the model.
+///
+/// Each model column is shown in a separate content widget; the widgets are
+/// created by createWidget() and populated by setWidgetData(), which may be
+/// overridden to customize the contents of the drawers. Changes made by the
+/// user in editable content widgets are written back to the model by
+/// setModelData(). All rows have the
+/// same height; by default, this is determined from the size hint of the first
+/// row that is shown.
+class QTE_EXPORT qtVirtualDrawerWidget : public QAbstractScrollArea
+{
+  Q_OBJECT
+  Q_PROPERTY(int rowHeight READ rowHeight WRITE setRowHeight)
+  Q_PROPERTY(qtDrawer::ExpanderPolicy expanderPolicy READ expanderPolicy
+                                                     WRITE setExpanderPolicy)
+
+public:
+  qtVirtualDrawerWidget(QWidget* parent = 0);
+  virtual ~qtVirtualDrawerWidget();
+
+  QAbstractItemModel* model() const;
+  virtual void setModel(QAbstractItemModel*);
+
+  int rowHeight() const;
+  void setRowHeight(int);
+
+  qtDrawer::ExpanderPolicy expanderPolicy() const;
+  void setExpanderPolicy(qtDrawer::ExpanderPolicy);
+
+  bool isExpanded(QModelIndex const&) const;
+
+  /// Get number of visible (i.e. not collapsed) rows.
+  ///
+  /// Structural changes to the model are applied when control returns to the
+  /// event loop; until then, this returns the number of rows prior to the
+  /// change.
+  int visibleRowCount() const;
+
+  /// Get the content widget for an index.
+  ///
+  /// This returns the widget that currently displays \p index, or null if
+  /// the drawer for \p index is not currently in (or near) the viewport.
+  /// Since widgets are recycled, the returned pointer should not be stored.
+  QWidget* indexWidget(QModelIndex const&) const;
+
+signals:
+  void expandToggled(QModelIndex const&, bool);
+
+public slots:
+  void setExpanded(QModelIndex const&, bool);
+  void scrollTo(QModelIndex const&);
+
+protected:
+  QTE_DECLARE_PRIVATE_RPTR(qtVirtualDrawerWidget)
+
+  /// Create content widget.
+  ///
+  /// This method is called to create the content widget for column \p column
+  /// of a drawer. The default implementation creates a QLabel.
+  virtual QWidget* createWidget(int column, QWidget* parent);
+
+  /// Populate content widget.
+  ///
+  /// This method is called to set the data of a (possibly recycled) content
+  /// widget to the data of \p index. The default implementation sets the text
+  /// of a QLabel to the display role data, or, for other widgets, sets the
+  /// widget's user property to the edit role data.
+  virtual void setWidgetData(QWidget* widget, QModelIndex const& index);
+
+  /// Write content widget data to the model.
+  ///
+  /// This method is called to write the data of a content widget back to
+  /// \p index when the widget's user property changes (if the property has a
+  /// notify signal), and before the widget is recycled. The default
+  /// implementation does nothing for a QLabel; for other widgets, it sets the
+  /// edit role data of \p index to the widget's user property, if the value
+  /// differs from the current data.
+  virtual void setModelData(QWidget* widget, QModelIndex const& index);
+
+  virtual void scrollContentsBy(int dx, int dy) QTE_OVERRIDE;
+  virtual void resizeEvent(QResizeEvent*) QTE_OVERRIDE;
+  virtual void changeEvent(QEvent*) QTE_OVERRIDE;
+
+protected slots:
+  void widgetDataChanged();
+
+private:
+  QTE_DECLARE_PRIVATE(qtVirtualDrawerWidget)
+  QTE_DISABLE_COPY(qtVirtualDrawerWidget)
+};
+
+#endif